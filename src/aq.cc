@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "interpreter/interpreter.h"
+#include "interpreter/optimizer.h"
 #include "lexer/lexer.h"
 #include "logging/logging.h"
 #include "parser/parser.h"
@@ -20,14 +21,52 @@ int main(int argc, char* argv[]) {
   try {
     // TODO(command-line arguments): Add more command-line arguments and
     // related-functions for the compiler.
-    if (argc < 2) {
-      LOGGING_ERROR("Usage: " + std::string(argv[0]) + " <code>");
+    // Gets the optimization level from -O<level>, where -O alone means -O1,
+    // the inline limit from -finline-limit=<words>, where -fno-inline means
+    // 0, whether to report the run statistics from -fstats, and the file from
+    // the first other argument.
+    const char* filename = nullptr;
+    bool print_stats = false;
+    for (int i = 1; i < argc; i++) {
+      std::string argument = argv[i];
+      if (argument == "-fstats") {
+        print_stats = true;
+        continue;
+      }
+      if (argument == "-fno-inline") {
+        Aq::Interpreter::SetInlineLimit(0);
+        continue;
+      }
+      if (argument.compare(0, 15, "-finline-limit=") == 0) {
+        std::string limit = argument.substr(15);
+        if (limit.empty() ||
+            limit.find_first_not_of("0123456789") != std::string::npos ||
+            limit.size() > 6)
+          LOGGING_ERROR("Invalid inline limit: " + argument);
+        Aq::Interpreter::SetInlineLimit(std::stoul(limit));
+        continue;
+      }
+      if (argument.compare(0, 2, "-O") != 0) {
+        if (filename == nullptr) filename = argv[i];
+        continue;
+      }
+      std::string level = argument.substr(2);
+      if (level.empty()) level = "1";
+      if (level.find_first_not_of("0123456789") != std::string::npos ||
+          level.size() > 2)
+        LOGGING_ERROR("Invalid optimization level: " + argument);
+      Aq::Interpreter::SetOptimizationLevel(std::stoi(level));
+    }
+    if (filename == nullptr) {
+      LOGGING_ERROR("Usage: " + std::string(argv[0]) +
+                    " [-O<level>] [-fno-inline] [-finline-limit=<words>] "
+                    "[-fstats] <code>");
       return -1;
     }
 
     // Gets the code from the file.
     std::vector<char> code;
-    Aq::ReadCodeFromFile(argv[1], code);
+    Aq::ReadCodeFromFile(filename, code);
 
     // Lexes the code and stores it in a vector of tokens.
     std::vector<Aq::Token> token;
@@ -40,8 +79,9 @@ int main(int argc, char* argv[]) {
     // Generates the bytecode from the AST.
     Aq::Interpreter::Interpreter interpreter;
     // Convert to absolute path for proper import resolution
-    std::filesystem::path source_path = std::filesystem::absolute(argv[1]);
+    std::filesystem::path source_path = std::filesystem::absolute(filename);
     interpreter.source_file_path = source_path.string();
+    interpreter.print_stats = print_stats;
     interpreter.Generate(ast);
 
     LOGGING_INFO("Generate Bytecode SUCCESS!");
@@ -0,0 +1,44 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#include "interpreter/allocator.h"
+
+#include "interpreter/memory.h"
+
+namespace Aq {
+namespace Interpreter {
+// The pools are never destroyed, so that objects dropped while the process
+// exits can still be given back.
+template <>
+Pool<Memory>& GetPool<Memory>() {
+  static Pool<Memory>* pool = new Pool<Memory>("Memory");
+  return *pool;
+}
+
+template <>
+Pool<ClassMemory>& GetPool<ClassMemory>() {
+  static Pool<ClassMemory>* pool = new Pool<ClassMemory>("ClassMemory");
+  return *pool;
+}
+
+template <>
+Pool<ObjectReference>& GetPool<ObjectReference>() {
+  static Pool<ObjectReference>* pool =
+      new Pool<ObjectReference>("ObjectReference");
+  return *pool;
+}
+
+template <>
+Pool<String>& GetPool<String>() {
+  static Pool<String>* pool = new Pool<String>("String");
+  return *pool;
+}
+
+std::vector<AllocationStats> GetAllocationStats() {
+  return {GetPool<Memory>().GetStats(), GetPool<ClassMemory>().GetStats(),
+          GetPool<ObjectReference>().GetStats(),
+          GetPool<String>().GetStats()};
+}
+}  // namespace Interpreter
+}  // namespace Aq
@@ -0,0 +1,120 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#ifndef AQ_INTERPRETER_ALLOCATOR_H_
+#define AQ_INTERPRETER_ALLOCATOR_H_
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "interpreter/inline.h"
+
+namespace Aq {
+namespace Interpreter {
+class Memory;
+class ClassMemory;
+class String;
+struct ObjectReference;
+
+// The counters of one pool.
+struct AllocationStats {
+  // The name of the pooled type.
+  const char* name = "";
+
+  // Objects handed out, and how many of them had to come from the heap
+  // because the pool had no free object.
+  std::size_t allocation_count = 0;
+  std::size_t heap_allocation_count = 0;
+
+  // Objects given back, and the bytes of all objects handed out.
+  std::size_t deallocation_count = 0;
+  std::size_t allocated_bytes = 0;
+};
+
+// Pool keeps the objects of type |T| that the runtime drops and hands them
+// out again, so that creating and dropping runtime objects in loops doesn't
+// go through malloc and free. Objects come from and go back to the global
+// operator new and delete, so objects created by a plain new can be given to
+// the pool as well.
+template <typename T>
+class Pool {
+ public:
+  // The most free objects a pool keeps. AddressSanitizer builds keep none so
+  // that every object is really freed and use after free is still caught.
+#if defined(__SANITIZE_ADDRESS__)
+  static constexpr std::size_t kMaxFreeObjects = 0;
+#else
+  static constexpr std::size_t kMaxFreeObjects = 4096;
+#endif
+
+  explicit Pool(const char* name) { stats_.name = name; }
+
+  template <typename... Arguments>
+  FORCE_INLINE T* New(Arguments&&... arguments) {
+    stats_.allocation_count++;
+    stats_.allocated_bytes += sizeof(T);
+
+    void* object = nullptr;
+    if (free_objects_.empty()) {
+      stats_.heap_allocation_count++;
+      object = ::operator new(sizeof(T));
+    } else {
+      object = free_objects_.back();
+      free_objects_.pop_back();
+    }
+    return new (object) T(std::forward<Arguments>(arguments)...);
+  }
+
+  FORCE_INLINE void Delete(T* object) {
+    stats_.deallocation_count++;
+    object->~T();
+    if (free_objects_.size() >= kMaxFreeObjects) {
+      ::operator delete(object);
+      return;
+    }
+    free_objects_.push_back(object);
+  }
+
+  const AllocationStats& GetStats() const { return stats_; }
+
+ private:
+  std::vector<void*> free_objects_;
+  AllocationStats stats_;
+};
+
+// Gets the pool of |T|. Pools exist for the types the runtime creates while
+// it runs: Memory, ClassMemory, ObjectReference and String.
+template <typename T>
+Pool<T>& GetPool();
+
+template <>
+Pool<Memory>& GetPool<Memory>();
+template <>
+Pool<ClassMemory>& GetPool<ClassMemory>();
+template <>
+Pool<ObjectReference>& GetPool<ObjectReference>();
+template <>
+Pool<String>& GetPool<String>();
+
+// Creates a |T| from |arguments| in its pool.
+template <typename T, typename... Arguments>
+FORCE_INLINE T* Allocate(Arguments&&... arguments) {
+  return GetPool<T>().New(std::forward<Arguments>(arguments)...);
+}
+
+// Destroys |object| and gives it back to its pool. Does nothing for nullptr,
+// like delete.
+template <typename T>
+FORCE_INLINE void Deallocate(T* object) {
+  if (object != nullptr) GetPool<T>().Delete(object);
+}
+
+// Gets the counters of all pools.
+std::vector<AllocationStats> GetAllocationStats();
+}  // namespace Interpreter
+}  // namespace Aq
+
+#endif
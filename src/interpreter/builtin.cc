@@ -8,9 +8,12 @@
 #include <cmath>
 #include <cstdio>
 #include <string>
+#include <type_traits>
 
+#include "interpreter/collector.h"
 #include "interpreter/interpreter.h"
 #include "interpreter/memory.h"
+#include "interpreter/simd.h"
 
 namespace Aq {
 namespace Interpreter {
@@ -85,6 +88,26 @@ void InitBuiltInFunctionDeclaration(Interpreter& interpreter) {
                                 __builtin_math_tan);
   AddBuiltInFunctionDeclaration(interpreter, "__builtin_math_tanh",
                                 __builtin_math_tanh);
+
+  AddBuiltInFunctionDeclaration(interpreter, "__builtin_array_sum",
+                                __builtin_array_sum);
+  AddBuiltInFunctionDeclaration(interpreter, "__builtin_array_dot",
+                                __builtin_array_dot);
+  AddBuiltInFunctionDeclaration(interpreter, "__builtin_array_min",
+                                __builtin_array_min);
+  AddBuiltInFunctionDeclaration(interpreter, "__builtin_array_max",
+                                __builtin_array_max);
+  AddBuiltInFunctionDeclaration(interpreter, "__builtin_array_add",
+                                __builtin_array_add);
+  AddBuiltInFunctionDeclaration(interpreter, "__builtin_array_mul",
+                                __builtin_array_mul);
+  AddBuiltInFunctionDeclaration(interpreter, "__builtin_array_fill",
+                                __builtin_array_fill);
+
+  AddBuiltInFunctionDeclaration(interpreter, "__builtin_gc_collected_count",
+                                __builtin_gc_collected_count);
+  AddBuiltInFunctionDeclaration(interpreter, "__builtin_gc_collection_count",
+                                __builtin_gc_collection_count);
 }
 
 int __builtin_void(Memory* memory, std::vector<std::size_t> arguments) {
@@ -409,7 +432,7 @@ int __builtin_math_frexp(Memory* memory, std::vector<std::size_t> arguments) {
   exp_object.data.int_data = exp;
   exp_object.constant_type = true;
 
-  Memory* array_memory = new Memory();
+  Memory* array_memory = Allocate<Memory>();
   array_memory->GetMemory().push_back(fraction_object);
   array_memory->GetMemory().push_back(exp_object);
 
@@ -468,7 +491,7 @@ int __builtin_math_modf(Memory* memory, std::vector<std::size_t> arguments) {
   int_part_object.data.int_data = int_part;
   int_part_object.constant_type = true;
 
-  Memory* array_memory = new Memory();
+  Memory* array_memory = Allocate<Memory>();
   array_memory->GetMemory().push_back(frac_object);
   array_memory->GetMemory().push_back(int_part_object);
 
@@ -525,5 +548,278 @@ int __builtin_math_tanh(Memory* memory, std::vector<std::size_t> arguments) {
   return 0;
 }
 
+// The array builtins run the kernels of simd.h over arrays of numbers. Packed
+// int and float arrays are passed to the kernels in place. The elements of
+// other arrays are converted into a buffer first, without unpacking packed
+// arrays. If an array holds a float, the elements are used as floats.
+
+// Gets the number of elements of |array|.
+std::size_t GetArraySize(Memory* array) {
+  return array->GetPackedType() != 0x00 ? array->GetPackedSize()
+                                        : array->GetMemory().size();
+}
+
+// Whether |array| is a float array or holds a float.
+bool HasFloatElements(Memory* array) {
+  if (array->GetPackedType() != 0x00) return array->GetPackedType() == 0x03;
+  for (Object& element : array->GetMemory())
+    if (GetOrigin(&element)->type == 0x03) return true;
+  return false;
+}
+
+// Gets the elements of |array| as |T|, which is int64_t or double. Elements
+// that aren't of |T| are converted into |buffer|.
+template <typename T>
+const T* GetNumericElements(Memory* array, std::vector<T>& buffer) {
+  constexpr bool is_float = std::is_same_v<T, double>;
+  uint8_t packed_type = array->GetPackedType();
+  if (packed_type == (is_float ? 0x03 : 0x02))
+    return static_cast<const T*>(array->GetPackedData());
+
+  std::size_t size = GetArraySize(array);
+  buffer.resize(size);
+  for (std::size_t i = 0; i < size; i++) {
+    switch (packed_type) {
+      case 0x00:
+        if constexpr (is_float) {
+          buffer[i] = GetDouble(&array->GetMemory()[i]);
+        } else {
+          buffer[i] = GetLong(&array->GetMemory()[i]);
+        }
+        break;
+      case 0x01:
+        buffer[i] = static_cast<T>(array->GetPacked<int8_t>(i));
+        break;
+      case 0x02:
+        buffer[i] = static_cast<T>(array->GetPacked<int64_t>(i));
+        break;
+      case 0x03:
+        buffer[i] = static_cast<T>(array->GetPacked<double>(i));
+        break;
+      default:
+        buffer[i] = static_cast<T>(array->GetPacked<uint64_t>(i));
+        break;
+    }
+  }
+  return buffer.data();
+}
+
+// Gets the arrays the element-wise builtins take. Both must have as many
+// elements.
+void GetArrayOperands(Object* memory_ptr, std::vector<std::size_t>& arguments,
+                      Memory*& a, Memory*& b, const char* name) {
+  if (arguments.size() != 3)
+    LOGGING_ERROR("Invalid number of arguments for " + std::string(name) +
+                  ". Expected 3, got " + std::to_string(arguments.size()));
+  a = GetArray(memory_ptr + arguments[1]);
+  b = GetArray(memory_ptr + arguments[2]);
+  if (GetArraySize(a) != GetArraySize(b))
+    LOGGING_ERROR("Arrays of different sizes for " + std::string(name) + ": " +
+                  std::to_string(GetArraySize(a)) + " and " +
+                  std::to_string(GetArraySize(b)));
+}
+
+int __builtin_array_sum(Memory* memory, std::vector<std::size_t> arguments) {
+  if (arguments.size() != 2)
+    LOGGING_ERROR(
+        "Invalid number of arguments for __builtin_array_sum. Expected 2, "
+        "got " +
+        std::to_string(arguments.size()));
+  auto memory_ptr = memory->GetMemory().data();
+  Memory* array = GetArray(memory_ptr + arguments[1]);
+
+  if (HasFloatElements(array)) {
+    std::vector<double> buffer;
+    SetDouble(memory_ptr + arguments[0],
+              SumDoubles(GetNumericElements(array, buffer),
+                         GetArraySize(array)));
+  } else {
+    std::vector<int64_t> buffer;
+    SetLong(memory_ptr + arguments[0],
+            SumLongs(GetNumericElements(array, buffer), GetArraySize(array)));
+  }
+  return 0;
+}
+
+int __builtin_array_dot(Memory* memory, std::vector<std::size_t> arguments) {
+  auto memory_ptr = memory->GetMemory().data();
+  Memory* a;
+  Memory* b;
+  GetArrayOperands(memory_ptr, arguments, a, b, "__builtin_array_dot");
+
+  if (HasFloatElements(a) || HasFloatElements(b)) {
+    std::vector<double> a_buffer, b_buffer;
+    SetDouble(memory_ptr + arguments[0],
+              DotDoubles(GetNumericElements(a, a_buffer),
+                         GetNumericElements(b, b_buffer), GetArraySize(a)));
+  } else {
+    std::vector<int64_t> a_buffer, b_buffer;
+    SetLong(memory_ptr + arguments[0],
+            DotLongs(GetNumericElements(a, a_buffer),
+                     GetNumericElements(b, b_buffer), GetArraySize(a)));
+  }
+  return 0;
+}
+
+// Runs __builtin_array_min or __builtin_array_max.
+int ReduceArray(Memory* memory, std::vector<std::size_t>& arguments,
+                bool is_min, const char* name) {
+  if (arguments.size() != 2)
+    LOGGING_ERROR("Invalid number of arguments for " + std::string(name) +
+                  ". Expected 2, got " + std::to_string(arguments.size()));
+  auto memory_ptr = memory->GetMemory().data();
+  Memory* array = GetArray(memory_ptr + arguments[1]);
+  std::size_t size = GetArraySize(array);
+  if (size == 0) LOGGING_ERROR("Empty array for " + std::string(name) + ".");
+
+  if (HasFloatElements(array)) {
+    std::vector<double> buffer;
+    const double* data = GetNumericElements(array, buffer);
+    SetDouble(memory_ptr + arguments[0],
+              is_min ? MinDoubles(data, size) : MaxDoubles(data, size));
+  } else {
+    std::vector<int64_t> buffer;
+    const int64_t* data = GetNumericElements(array, buffer);
+    SetLong(memory_ptr + arguments[0],
+            is_min ? MinLongs(data, size) : MaxLongs(data, size));
+  }
+  return 0;
+}
+
+int __builtin_array_min(Memory* memory, std::vector<std::size_t> arguments) {
+  return ReduceArray(memory, arguments, true, "__builtin_array_min");
+}
+
+int __builtin_array_max(Memory* memory, std::vector<std::size_t> arguments) {
+  return ReduceArray(memory, arguments, false, "__builtin_array_max");
+}
+
+// Runs __builtin_array_add or __builtin_array_mul. The result is a new packed
+// array.
+int CombineArrays(Memory* memory, std::vector<std::size_t>& arguments,
+                  bool is_add, const char* name) {
+  auto memory_ptr = memory->GetMemory().data();
+  Memory* a;
+  Memory* b;
+  GetArrayOperands(memory_ptr, arguments, a, b, name);
+  std::size_t size = GetArraySize(a);
+
+  Memory* result = Allocate<Memory>();
+  if (HasFloatElements(a) || HasFloatElements(b)) {
+    std::vector<double> a_buffer, b_buffer;
+    const double* a_data = GetNumericElements(a, a_buffer);
+    const double* b_data = GetNumericElements(b, b_buffer);
+    result->InitPacked(0x03, size);
+    double* result_data = static_cast<double*>(result->GetPackedData());
+    if (is_add) {
+      AddDoubles(a_data, b_data, result_data, size);
+    } else {
+      MulDoubles(a_data, b_data, result_data, size);
+    }
+  } else {
+    std::vector<int64_t> a_buffer, b_buffer;
+    const int64_t* a_data = GetNumericElements(a, a_buffer);
+    const int64_t* b_data = GetNumericElements(b, b_buffer);
+    result->InitPacked(0x02, size);
+    int64_t* result_data = static_cast<int64_t*>(result->GetPackedData());
+    if (is_add) {
+      AddLongs(a_data, b_data, result_data, size);
+    } else {
+      MulLongs(a_data, b_data, result_data, size);
+    }
+  }
+
+  SetArray(memory_ptr + arguments[0], result);
+  return 0;
+}
+
+int __builtin_array_add(Memory* memory, std::vector<std::size_t> arguments) {
+  return CombineArrays(memory, arguments, true, "__builtin_array_add");
+}
+
+int __builtin_array_mul(Memory* memory, std::vector<std::size_t> arguments) {
+  return CombineArrays(memory, arguments, false, "__builtin_array_mul");
+}
+
+int __builtin_array_fill(Memory* memory, std::vector<std::size_t> arguments) {
+  if (arguments.size() != 3)
+    LOGGING_ERROR(
+        "Invalid number of arguments for __builtin_array_fill. Expected 3, "
+        "got " +
+        std::to_string(arguments.size()));
+  auto memory_ptr = memory->GetMemory().data();
+  Memory* array = GetArray(memory_ptr + arguments[1]);
+  Object* value = GetOrigin(memory_ptr + arguments[2]);
+
+  // Packed arrays are filled in place if their elements take the value the
+  // way STORE_ELEMENT would store it.
+  bool is_constant = array->GetPackedConstantSize() == array->GetPackedSize();
+  switch (array->GetPackedType()) {
+    case 0x02:
+      if (value->type == 0x01 || value->type == 0x02) {
+        FillLongs(static_cast<int64_t*>(array->GetPackedData()),
+                  array->GetPackedSize(), GetLong(value));
+        return 0;
+      }
+      break;
+    case 0x03:
+      if (value->type == 0x03 ||
+          (is_constant && (value->type == 0x01 || value->type == 0x02))) {
+        FillDoubles(static_cast<double*>(array->GetPackedData()),
+                    array->GetPackedSize(), GetDouble(value));
+        return 0;
+      }
+      break;
+    default:
+      break;
+  }
+
+  for (Object& element : array->GetMemory()) {
+    switch (value->type) {
+      case 0x01:
+        SetByte(&element, value->data.byte_data);
+        break;
+      case 0x02:
+        SetLong(&element, value->data.int_data);
+        break;
+      case 0x03:
+        SetDouble(&element, value->data.float_data);
+        break;
+      case 0x04:
+        SetUint64(&element, value->data.uint64t_data);
+        break;
+      default:
+        LOGGING_ERROR("Unsupported object type in __builtin_array_fill: " +
+                      std::to_string(value->type));
+        return -1;
+    }
+  }
+  return 0;
+}
+
+int __builtin_gc_collected_count(Memory* memory,
+                                 std::vector<std::size_t> arguments) {
+  if (arguments.size() != 1)
+    LOGGING_ERROR(
+        "Invalid number of arguments for __builtin_gc_collected_count. "
+        "Expected 1, got " +
+        std::to_string(arguments.size()));
+  SetLong(memory->GetMemory().data() + arguments[0],
+          GetCollectorStats().collected_object_count);
+  return 0;
+}
+
+int __builtin_gc_collection_count(Memory* memory,
+                                  std::vector<std::size_t> arguments) {
+  if (arguments.size() != 1)
+    LOGGING_ERROR(
+        "Invalid number of arguments for __builtin_gc_collection_count. "
+        "Expected 1, got " +
+        std::to_string(arguments.size()));
+  SetLong(memory->GetMemory().data() + arguments[0],
+          GetCollectorStats().collection_count);
+  return 0;
+}
+
 }  // namespace Interpreter
 }  // namespace Aq
@@ -90,6 +90,22 @@ int __builtin_math_tan(Memory* memory, std::vector<std::size_t> arguments);
 
 int __builtin_math_tanh(Memory* memory, std::vector<std::size_t> arguments);
 
+int __builtin_array_sum(Memory* memory, std::vector<std::size_t> arguments);
+int __builtin_array_dot(Memory* memory, std::vector<std::size_t> arguments);
+int __builtin_array_min(Memory* memory, std::vector<std::size_t> arguments);
+int __builtin_array_max(Memory* memory, std::vector<std::size_t> arguments);
+int __builtin_array_add(Memory* memory, std::vector<std::size_t> arguments);
+int __builtin_array_mul(Memory* memory, std::vector<std::size_t> arguments);
+int __builtin_array_fill(Memory* memory, std::vector<std::size_t> arguments);
+
+// Gets the number of objects the garbage collector freed so far.
+int __builtin_gc_collected_count(Memory* memory,
+                                 std::vector<std::size_t> arguments);
+
+// Gets the number of times the garbage collector ran so far.
+int __builtin_gc_collection_count(Memory* memory,
+                                  std::vector<std::size_t> arguments);
+
 }  // namespace Interpreter
 }  // namespace Aq
 
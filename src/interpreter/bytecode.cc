@@ -0,0 +1,247 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#include "interpreter/bytecode.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "interpreter/operator.h"
+#include "logging/logging.h"
+
+namespace Aq {
+namespace Interpreter {
+// Narrows |operand| to the width of a bytecode operand.
+uint32_t PackOperand(std::size_t operand) {
+  if (operand > UINT32_MAX)
+    INTERNAL_ERROR("Operand " + std::to_string(operand) +
+                   " does not fit into a bytecode.");
+  return static_cast<uint32_t>(operand);
+}
+
+// Stores up to four |operands| starting at |begin| into |bytecode|.
+void PackOperands(Bytecode& bytecode, const std::size_t* begin,
+                  std::size_t size) {
+  uint32_t* slots[] = {&bytecode.operand1, &bytecode.operand2,
+                       &bytecode.operand3, &bytecode.operand4};
+  for (std::size_t i = 0; i < 4; i++)
+    *slots[i] = i < size ? PackOperand(begin[i]) : 0;
+}
+
+std::size_t MakeImmediate(std::size_t value) {
+  if (value >= kImmediateOperandFlag)
+    INTERNAL_ERROR("Immediate " + std::to_string(value) + " is too large.");
+  return value | kImmediateOperandFlag;
+}
+
+Bytecode::Bytecode(uint8_t oper, std::initializer_list<std::size_t> operands)
+    : oper(oper) {
+  if (operands.size() > 4)
+    INTERNAL_ERROR("Too many operands for a fixed-width bytecode.");
+  size = operands.size();
+  PackOperands(*this, operands.begin(), operands.size());
+}
+
+void Bytecode::SetOperands(const std::vector<std::size_t>& operands) {
+  if (operands.size() > 4)
+    INTERNAL_ERROR("Too many operands for a fixed-width bytecode.");
+  size = operands.size();
+  PackOperands(*this, operands.data(), operands.size());
+}
+
+void AppendBytecode(std::vector<Bytecode>& code, uint8_t oper,
+                    const std::vector<std::size_t>& operands) {
+  if (operands.size() > UINT16_MAX)
+    INTERNAL_ERROR("Too many operands for a bytecode.");
+
+  Bytecode bytecode;
+  bytecode.oper = oper;
+  bytecode.size = operands.size();
+  PackOperands(bytecode, operands.data(), operands.size());
+  code.push_back(bytecode);
+
+  for (std::size_t i = 4; i < operands.size(); i += 4) {
+    Bytecode extension;
+    extension.oper = _AQVM_OPERATOR_WIDE;
+    extension.size = operands.size() - i < 4 ? operands.size() - i : 4;
+    PackOperands(extension, operands.data() + i, extension.size);
+    code.push_back(extension);
+  }
+}
+
+std::vector<std::size_t> GetOperands(const Bytecode* code,
+                                     std::size_t frame_base) {
+  std::vector<std::size_t> operands(code->size);
+  for (std::size_t i = 0; i < operands.size(); i++) {
+    const Bytecode& word = code[i / 4];
+    uint32_t operand = i % 4 == 0   ? word.operand1
+                       : i % 4 == 1 ? word.operand2
+                       : i % 4 == 2 ? word.operand3
+                                    : word.operand4;
+    operands[i] = ResolveOperand(operand, frame_base);
+  }
+  return operands;
+}
+// Returns true if |position| in |code| starts a CMP whose result is tested by
+// the IF that follows it.
+bool IsCompareAndBranch(const std::vector<Bytecode>& code,
+                        std::size_t position) {
+  if (position + 1 >= code.size()) return false;
+  const Bytecode& compare = code[position];
+  const Bytecode& branch = code[position + 1];
+  return (compare.oper == _AQVM_OPERATOR_CMP ||
+          compare.oper == _AQVM_OPERATOR_CMPI ||
+          compare.oper == _AQVM_OPERATOR_CMPF ||
+          compare.oper == _AQVM_OPERATOR_CMP_IF ||
+          compare.oper == _AQVM_OPERATOR_CMPI_IF ||
+          compare.oper == _AQVM_OPERATOR_CMPF_IF) &&
+         branch.oper == _AQVM_OPERATOR_IF &&
+         branch.operand1 == compare.operand1;
+}
+
+void FuseSuperinstructions(std::vector<Bytecode>& code) {
+  // Branches are fused first because the loop increments compete with the
+  // pairs below for their ADDI.
+  for (std::size_t i = 0; i + 1 < code.size();
+       i += 1 + code[i].GetExtensionSize()) {
+    if (IsCompareAndBranch(code, i)) {
+      if (code[i].oper == _AQVM_OPERATOR_CMPI) {
+        code[i].oper = _AQVM_OPERATOR_CMPI_IF;
+      } else if (code[i].oper == _AQVM_OPERATOR_CMPF) {
+        code[i].oper = _AQVM_OPERATOR_CMPF_IF;
+      } else if (code[i].oper == _AQVM_OPERATOR_CMP) {
+        code[i].oper = _AQVM_OPERATOR_CMP_IF;
+      }
+      fused_instruction_count++;
+    } else if (code[i].oper == _AQVM_OPERATOR_ADDI &&
+               code[i + 1].oper == _AQVM_OPERATOR_GOTO &&
+               IsCompareAndBranch(code, code[i + 1].operand1)) {
+      code[i].oper = _AQVM_OPERATOR_INC_CMP_IF;
+      fused_instruction_count++;
+    }
+  }
+
+  for (std::size_t i = 0; i + 1 < code.size();
+       i += 1 + code[i].GetExtensionSize()) {
+    Bytecode& first = code[i];
+    const Bytecode& second = code[i + 1];
+    switch (first.oper) {
+      case _AQVM_OPERATOR_ADD:
+      case _AQVM_OPERATOR_ADDI:
+      case _AQVM_OPERATOR_ADDF:
+        if (second.oper == _AQVM_OPERATOR_EQUAL &&
+            second.operand2 == first.operand1) {
+          first.oper = _AQVM_OPERATOR_ADD_STORE;
+          fused_instruction_count++;
+        }
+        break;
+      case _AQVM_OPERATOR_SUB:
+      case _AQVM_OPERATOR_SUBI:
+      case _AQVM_OPERATOR_SUBF:
+        if (second.oper == _AQVM_OPERATOR_EQUAL &&
+            second.operand2 == first.operand1) {
+          first.oper = _AQVM_OPERATOR_SUB_STORE;
+          fused_instruction_count++;
+        }
+        break;
+      case _AQVM_OPERATOR_MUL:
+      case _AQVM_OPERATOR_MULI:
+      case _AQVM_OPERATOR_MULF:
+        if (second.oper == _AQVM_OPERATOR_EQUAL &&
+            second.operand2 == first.operand1) {
+          first.oper = _AQVM_OPERATOR_MUL_STORE;
+          fused_instruction_count++;
+        }
+        break;
+      case _AQVM_OPERATOR_EQUAL:
+        // Postfix increment of a local. Skipped if the ADDI already heads an
+        // INC_CMP_IF pair.
+        if (second.oper == _AQVM_OPERATOR_ADDI &&
+            second.operand1 == first.operand2 &&
+            second.operand2 == first.operand2 &&
+            IsFrameOperand(second.operand1)) {
+          first.oper = _AQVM_OPERATOR_ADD_TO_LOCAL;
+          fused_instruction_count++;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+// Returns true if |instruction| reads the slot |operand| as a value and
+// doesn't write it.
+bool IsValueRead(const Bytecode& instruction, uint32_t operand) {
+  if (instruction.operand1 == operand) return false;
+  switch (instruction.oper) {
+    case _AQVM_OPERATOR_ADD:
+    case _AQVM_OPERATOR_SUB:
+    case _AQVM_OPERATOR_MUL:
+    case _AQVM_OPERATOR_DIV:
+    case _AQVM_OPERATOR_REM:
+    case _AQVM_OPERATOR_SHL:
+    case _AQVM_OPERATOR_SHR:
+    case _AQVM_OPERATOR_AND:
+    case _AQVM_OPERATOR_OR:
+    case _AQVM_OPERATOR_XOR:
+    case _AQVM_OPERATOR_ADD_STORE:
+    case _AQVM_OPERATOR_SUB_STORE:
+    case _AQVM_OPERATOR_MUL_STORE:
+      return instruction.operand2 == operand || instruction.operand3 == operand;
+    case _AQVM_OPERATOR_NEG:
+    case _AQVM_OPERATOR_EQUAL:
+      return instruction.operand2 == operand;
+    case _AQVM_OPERATOR_CMP:
+    case _AQVM_OPERATOR_CMPI:
+    case _AQVM_OPERATOR_CMPF:
+    case _AQVM_OPERATOR_CMP_IF:
+    case _AQVM_OPERATOR_CMPI_IF:
+    case _AQVM_OPERATOR_CMPF_IF:
+      return instruction.operand3 == operand || instruction.operand4 == operand;
+    default:
+      return false;
+  }
+}
+
+void SpecializeElementAccess(std::vector<Bytecode>& code) {
+  // Counts how often every slot is named. Fields that aren't operands are
+  // counted too, which only makes the rewrite rarer.
+  std::unordered_map<uint32_t, std::size_t> uses;
+  for (const Bytecode& word : code) {
+    uses[word.operand1]++;
+    uses[word.operand2]++;
+    uses[word.operand3]++;
+    uses[word.operand4]++;
+  }
+
+  for (std::size_t i = 0; i + 1 < code.size();
+       i += 1 + code[i].GetExtensionSize()) {
+    Bytecode& access = code[i];
+    if (access.oper != _AQVM_OPERATOR_ARRAY || uses[access.operand1] != 2)
+      continue;
+
+    if (code[i + 1].oper == _AQVM_OPERATOR_EQUAL &&
+        code[i + 1].operand1 == access.operand1) {
+      access.oper = _AQVM_OPERATOR_STORE_ELEMENT;
+      specialized_element_access_count++;
+      continue;
+    }
+
+    // Loads of the other operands of the reading instruction, as in
+    // a[i] + a[j], may come in between since they change no element.
+    std::size_t reader = i + 1;
+    while (reader + 1 < code.size() &&
+           (code[reader].oper == _AQVM_OPERATOR_ARRAY ||
+            code[reader].oper == _AQVM_OPERATOR_LOAD_ELEMENT))
+      reader++;
+    if (IsValueRead(code[reader], access.operand1)) {
+      access.oper = _AQVM_OPERATOR_LOAD_ELEMENT;
+      specialized_element_access_count++;
+    }
+  }
+}
+}  // namespace Interpreter
+}  // namespace Aq
@@ -7,14 +7,99 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <vector>
 
+#include "interpreter/inline.h"
+
 namespace Aq {
 namespace Interpreter {
+// Operands with this bit set address a slot in the activation frame of the
+// running function instead of an absolute slot in the memory. The remaining
+// bits are the offset of the slot from the start of the frame.
+constexpr std::size_t kFrameOperandFlag = std::size_t(1) << 31;
+
+// Returns true if |operand| addresses a slot in the activation frame.
+FORCE_INLINE bool IsFrameOperand(std::size_t operand) {
+  return (operand & kFrameOperandFlag) != 0;
+}
+
+// Converts |operand| into an absolute memory index. Frame operands are offset
+// by |frame_base|, other operands are returned unchanged.
+FORCE_INLINE std::size_t ResolveOperand(std::size_t operand,
+                                        std::size_t frame_base) {
+  return (operand & ~kFrameOperandFlag) +
+         (frame_base & (std::size_t(0) - ((operand >> 31) & 1)));
+}
+
+// Operands with this bit set and the frame bit clear carry a small literal,
+// such as an array index or an allocation size, in the remaining bits instead
+// of addressing a slot.
+constexpr std::size_t kImmediateOperandFlag = std::size_t(1) << 30;
+
+// Returns true if |operand| carries a literal.
+FORCE_INLINE bool IsImmediateOperand(std::size_t operand) {
+  return (operand & (kFrameOperandFlag | kImmediateOperandFlag)) ==
+         kImmediateOperandFlag;
+}
+
+// Gets the literal carried by an immediate |operand|.
+FORCE_INLINE std::size_t GetImmediate(std::size_t operand) {
+  return operand & ~kImmediateOperandFlag;
+}
+
+// Makes an immediate operand carrying |value|.
+std::size_t MakeImmediate(std::size_t value);
+
+// A packed instruction. Up to four 32-bit operands are stored inline. The
+// operands of variable-arity operators that don't fit continue in WIDE
+// extension words directly following the instruction, four per word. The
+// interpreter runs the code in this form and skips the extension words.
 struct Bytecode {
+  Bytecode() = default;
+  Bytecode(uint8_t oper, std::initializer_list<std::size_t> operands);
+
+  // Replaces the operands of an instruction with at most four operands.
+  void SetOperands(const std::vector<std::size_t>& operands);
+
+  // Gets the number of WIDE extension words following the instruction.
+  std::size_t GetExtensionSize() const {
+    return size > 4 ? (size - 4 + 3) / 4 : 0;
+  }
+
   uint8_t oper = 0x00;
-  std::vector<std::size_t> arguments;
+
+  // Set once a quickened form of the instruction failed its type guard. The
+  // instruction then stays on the generic operator.
+  bool is_deoptimized = false;
+
+  // Total number of operands, including those in the extension words.
+  uint16_t size = 0;
+
+  uint32_t operand1 = 0;
+  uint32_t operand2 = 0;
+  uint32_t operand3 = 0;
+  uint32_t operand4 = 0;
 };
+
+// Appends an instruction with any number of |operands| to |code|, followed by
+// the extension words it needs.
+void AppendBytecode(std::vector<Bytecode>& code, uint8_t oper,
+                    const std::vector<std::size_t>& operands);
+
+// Gets all operands of the instruction at |code|, reading the extension words
+// that follow it, with every frame operand resolved against |frame_base|.
+std::vector<std::size_t> GetOperands(const Bytecode* code,
+                                     std::size_t frame_base);
+
+// Rewrites common pairs of instructions in |code| into the superinstructions
+// declared in operator.h. Run once on the finished code of every function.
+void FuseSuperinstructions(std::vector<Bytecode>& code);
+
+// Rewrites the ARRAY instructions in |code| whose result is only used by the
+// next instruction into the element loads and stores declared in operator.h.
+// Run once after FuseSuperinstructions().
+void SpecializeElementAccess(std::vector<Bytecode>& code);
 }  // namespace Interpreter
 }  // namespace Aq
 
@@ -20,6 +20,7 @@ class Class {
   Class() {
     members_ = new ClassMemory();
     members_->AddReferenceCount();
+    AddRoot(members_);
     class_ = nullptr;
   }
   ~Class() = default;
@@ -31,10 +32,10 @@ class Class {
   }
 
   bool GetVariable(std::string name, Object& object) {
-    if (members_->GetMembers().find(name) == members_->GetMembers().end())
-      return false;
+    Object* member = members_->FindMember(InternSymbol(name));
+    if (member == nullptr) return false;
 
-    object = members_->GetMembers()[name];
+    object = *member;
     return true;
   }
 
@@ -0,0 +1,135 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#include "interpreter/collector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+
+#include "interpreter/allocator.h"
+#include "interpreter/memory.h"
+
+namespace Aq {
+namespace Interpreter {
+// The fewest collectable objects created between two collections. After a
+// collection, the next one waits until as many objects were created as
+// survived, so the time spent tracing stays proportional to the time spent
+// allocating.
+constexpr std::size_t kMinCollectionThreshold = 1 << 16;
+
+Collectable* Collectable::first_ = nullptr;
+std::size_t Collectable::created_count_ = 0;
+std::size_t Collectable::collection_threshold_ = kMinCollectionThreshold;
+bool Collectable::collection_requested_ = false;
+
+// The roots of the collector and its counters.
+std::vector<Collectable*> roots;
+CollectorStats collector_stats;
+
+void AddRoot(Collectable* object) {
+  if (object == nullptr || object->is_root_) return;
+  object->Unlink();
+  object->previous_ = object->next_ = nullptr;
+  object->is_root_ = true;
+  roots.push_back(object);
+}
+
+void CollectGarbage() {
+  auto start_time = std::chrono::high_resolution_clock::now();
+
+  // Temporaries may still hold pointers to objects that reference counting
+  // already freed, such as references to members of a dropped class object.
+  // Only pointers to objects that exist are followed.
+  std::unordered_set<Collectable*> objects(roots.begin(), roots.end());
+  for (Collectable* object = Collectable::first_; object != nullptr;
+       object = object->next_)
+    objects.insert(object);
+
+  // Marks the objects reachable from the roots. |pending| holds the marked
+  // objects whose children weren't traced yet, so long lists don't overflow
+  // the native stack.
+  std::vector<Collectable*> pending;
+  auto mark = [&objects, &pending](Collectable* object) {
+    if (objects.count(object) == 0 || object->is_marked_) return;
+    object->is_marked_ = true;
+    pending.push_back(object);
+  };
+  for (Collectable* root : roots) mark(root);
+  while (!pending.empty()) {
+    Collectable* object = pending.back();
+    pending.pop_back();
+    for (Object& child : object->GetTracedObjects()) {
+      switch (child.type) {
+        case 0x06:
+          mark(child.data.array_data);
+          break;
+        case 0x07:
+          if (child.data.reference_data == nullptr) break;
+          if (child.data.reference_data->is_class) {
+            mark(child.data.reference_data->memory.class_memory);
+          } else {
+            mark(child.data.reference_data->memory.memory);
+          }
+          break;
+        case 0x09:
+          mark(child.data.class_data);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  // Sweeps the objects that weren't marked. The collectable objects they hold
+  // are either garbage too or alive, so their reference counts are left
+  // alone. The strings and reference structs the slots own are released like
+  // InitGc() does when a slot is overwritten, without touching the targets of
+  // the references.
+  std::vector<Collectable*> garbage;
+  std::size_t survivor_count = 0;
+  for (Collectable* object = Collectable::first_; object != nullptr;
+       object = object->next_) {
+    if (object->is_marked_) {
+      object->is_marked_ = false;
+      survivor_count++;
+    } else {
+      garbage.push_back(object);
+    }
+  }
+  for (Collectable* root : roots) root->is_marked_ = false;
+
+  for (Collectable* object : garbage) {
+    for (Object& child : object->GetTracedObjects()) {
+      if (child.type == 0x05 && child.data.string_data != nullptr) {
+        child.data.string_data->RemoveReferenceCount();
+        child.data.string_data = nullptr;
+      } else if (child.type == 0x07 && child.data.reference_data != nullptr) {
+        Deallocate(child.data.reference_data);
+        child.data.reference_data = nullptr;
+      }
+    }
+  }
+
+  std::size_t collected_bytes = 0;
+  for (Collectable* object : garbage) collected_bytes += object->Free();
+
+  Collectable::created_count_ = 0;
+  Collectable::collection_threshold_ =
+      std::max(kMinCollectionThreshold, survivor_count);
+  Collectable::collection_requested_ = false;
+
+  auto end_time = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double, std::milli> pause = end_time - start_time;
+  collector_stats.collection_count++;
+  collector_stats.collected_object_count += garbage.size();
+  collector_stats.collected_bytes += collected_bytes;
+  collector_stats.total_pause += pause.count();
+  collector_stats.max_pause =
+      std::max(collector_stats.max_pause, pause.count());
+}
+
+const CollectorStats& GetCollectorStats() { return collector_stats; }
+}  // namespace Interpreter
+}  // namespace Aq
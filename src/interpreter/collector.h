@@ -0,0 +1,109 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#ifndef AQ_INTERPRETER_COLLECTOR_H_
+#define AQ_INTERPRETER_COLLECTOR_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "interpreter/inline.h"
+
+namespace Aq {
+namespace Interpreter {
+struct Object;
+
+// Collectable is the base of the runtime objects that hold other objects:
+// arrays (Memory) and class instances (ClassMemory). Reference counting frees
+// most of them, but objects that hold each other (linked lists, parent
+// pointers) keep their counts above zero forever. The collector finds such
+// objects by tracing from the roots and frees the ones it can't reach.
+//
+// Every collectable object is kept in a list from its construction to its
+// destruction. Objects made roots by AddRoot() leave the list and are never
+// collected.
+class Collectable {
+ public:
+  Collectable() { Link(); }
+  Collectable(const Collectable&) { Link(); }
+  virtual ~Collectable() { Unlink(); }
+
+  // Copying an object copies its contents, not its place in the list.
+  Collectable& operator=(const Collectable&) { return *this; }
+
+  // Gets the objects this object holds, which the collector traces.
+  virtual std::vector<Object>& GetTracedObjects() = 0;
+
+  // Destroys the object for the collector and returns the bytes it held.
+  virtual std::size_t Free() = 0;
+
+  // Whether enough collectable objects were created since the last
+  // collection that the next safe point should collect.
+  static bool IsCollectionRequested() { return collection_requested_; }
+
+ private:
+  friend void AddRoot(Collectable* object);
+  friend void CollectGarbage();
+
+  FORCE_INLINE void Link() {
+    next_ = first_;
+    if (first_ != nullptr) first_->previous_ = this;
+    first_ = this;
+    if (++created_count_ >= collection_threshold_) collection_requested_ = true;
+  }
+
+  FORCE_INLINE void Unlink() {
+    if (is_root_) return;
+    if (previous_ != nullptr) {
+      previous_->next_ = next_;
+    } else {
+      first_ = next_;
+    }
+    if (next_ != nullptr) next_->previous_ = previous_;
+  }
+
+  Collectable* previous_ = nullptr;
+  Collectable* next_ = nullptr;
+  bool is_marked_ = false;
+  bool is_root_ = false;
+
+  // The list of collectable objects that aren't roots.
+  static Collectable* first_;
+
+  // Collectable objects created since the last collection, and how many may
+  // be created before the next one.
+  static std::size_t created_count_;
+  static std::size_t collection_threshold_;
+  static bool collection_requested_;
+};
+
+// The counters of the collector.
+struct CollectorStats {
+  std::size_t collection_count = 0;
+
+  // Objects freed by the collector and the bytes they held.
+  std::size_t collected_object_count = 0;
+  std::size_t collected_bytes = 0;
+
+  // Time spent in collections, in milliseconds.
+  double total_pause = 0;
+  double max_pause = 0;
+};
+
+// Makes |object| a root. Roots are never collected, and objects reachable
+// from them are kept. The global memory of interpreters and the members of
+// class templates are roots.
+void AddRoot(Collectable* object);
+
+// Frees the collectable objects that aren't reachable from the roots. Only
+// call this at a safe point, when every object in use is reachable from a
+// root.
+void CollectGarbage();
+
+// Gets the counters of the collector.
+const CollectorStats& GetCollectorStats();
+}  // namespace Interpreter
+}  // namespace Aq
+
+#endif
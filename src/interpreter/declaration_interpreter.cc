@@ -14,9 +14,11 @@
 #include "ast/type.h"
 #include "interpreter/bytecode.h"
 #include "interpreter/expression_interpreter.h"
+#include "interpreter/frame.h"
 #include "interpreter/interpreter.h"
 #include "interpreter/memory.h"
 #include "interpreter/operator.h"
+#include "interpreter/optimizer.h"
 #include "interpreter/statement_interpreter.h"
 #include "logging/logging.h"
 #include "operator.h"
@@ -153,6 +155,10 @@ void HandleFunctionDeclaration(Interpreter& interpreter,
     return;
   }
 
+  // Locals live in an activation frame unless the body can capture them.
+  interpreter.context.function_context->has_frame =
+      CanUseFrame(declaration->GetFunctionBody());
+
   // Handles function parameters and return value.
   std::vector<std::size_t> parameters_index;
   HandleReturnVariableInHandlingFunction(interpreter, declaration, scope_name,
@@ -216,6 +222,10 @@ void HandleClassFunctionDeclaration(Interpreter& interpreter,
     return;
   }
 
+  // Locals live in an activation frame unless the body can capture them.
+  interpreter.context.function_context->has_frame =
+      CanUseFrame(declaration->GetFunctionBody());
+
   // Handles function parameters and return value.
   std::vector<std::size_t> parameters_index;
   HandleReturnVariableInHandlingFunction(interpreter, declaration, scope_name,
@@ -303,7 +313,6 @@ std::size_t HandleVariableDeclaration(Interpreter& interpreter,
   if (declaration == nullptr) INTERNAL_ERROR("declaration is nullptr.");
 
   // Gets the reference of context.
-  auto& memory = interpreter.global_memory;
   auto& scopes = interpreter.context.scopes;
   auto& variables = interpreter.context.variables;
 
@@ -330,7 +339,7 @@ std::size_t HandleVariableDeclaration(Interpreter& interpreter,
     alloc_type = 0x00;  // Use auto type for class variables with initialization
   }
 
-  std::size_t variable_index = memory->AddWithType(alloc_type);
+  std::size_t variable_index = AddLocal(interpreter, alloc_type);
 
   // If the variable value isn't nullptr, it means that the variable is
   // initialized.
@@ -534,7 +543,7 @@ std::size_t HandleClassVariableDeclaration(Interpreter& interpreter,
     code.push_back(
         Bytecode{_AQVM_OPERATOR_LOAD_MEMBER,
                  {temp_reference_index, 0,
-                  global_memory->AddString(variable_name)}});
+                  MakeImmediate(InternSymbol(variable_name))}});
     HandleClassInHandlingVariable(interpreter, declaration, temp_reference_index,
                                   code);
   }
@@ -549,7 +558,7 @@ std::size_t HandleClassVariableDeclaration(Interpreter& interpreter,
     code.push_back(
         Bytecode{_AQVM_OPERATOR_LOAD_MEMBER,
                  {temp_reference_index, 0,
-                  global_memory->AddString(variable_name)}});
+                  MakeImmediate(InternSymbol(variable_name))}});
     code.push_back(
         Bytecode{_AQVM_OPERATOR_EQUAL, {temp_reference_index, value_index}});
   } else if (category == Ast::Type::TypeCategory::kReference) {
@@ -583,7 +592,7 @@ std::size_t HandleArrayDeclaration(Interpreter& interpreter,
       scopes.back() + "#" + declaration->GetVariableName();
 
   // Adds the array index and the type index.
-  std::size_t array_index = global_memory->AddWithType(array_type->GetVmType());
+  std::size_t array_index = AddLocal(interpreter, array_type->GetVmType());
   std::size_t array_type_index = 0;
 
   // Gets the sub type of the array type and its category.
@@ -618,24 +627,24 @@ std::size_t HandleArrayDeclaration(Interpreter& interpreter,
   // because it is smaller than the array size, it will not be automatically
   // initialized when the ARRAY operator is called.
   if (sub_type_category == Ast::Type::TypeCategory::kClass) {
-    std::size_t current_index = global_memory->Add(1);
+    std::size_t current_index = AddLocal(interpreter);
     code.push_back(
         Bytecode{_AQVM_OPERATOR_ARRAY,
-                 {current_index, array_index, global_memory->AddUint64t(0)}});
+                 {current_index, array_index, MakeImmediate(0)}});
     code.push_back(
         Bytecode{_AQVM_OPERATOR_INVOKE_METHOD,
                  {current_index, global_memory->AddString("@constructor"),
-                  global_memory->Add(1)}});
+                  AddLocal(interpreter)}});
   }
 
   // Handles the array initialization with the initialization lists.
   if (!declaration->GetVariableValue().empty()) {
     for (std::size_t i = 0; i < declaration->GetVariableValue().size(); i++) {
       // Gets the corresponding array index reference.
-      std::size_t current_index = global_memory->Add(1);
+      std::size_t current_index = AddLocal(interpreter);
       code.push_back(
           Bytecode{_AQVM_OPERATOR_ARRAY,
-                   {current_index, array_index, global_memory->AddUint64t(i)}});
+                   {current_index, array_index, MakeImmediate(i)}});
 
       // Gets the value of the initialization list and assigns value to
       // corresponding index.
@@ -711,7 +720,7 @@ std::size_t HandleGlobalArrayDeclaration(Interpreter& interpreter,
     std::size_t current_index = global_memory->Add(1);
     code.push_back(
         Bytecode{_AQVM_OPERATOR_ARRAY,
-                 {current_index, array_index, global_memory->AddUint64t(0)}});
+                 {current_index, array_index, MakeImmediate(0)}});
     code.push_back(
         Bytecode{_AQVM_OPERATOR_INVOKE_METHOD,
                  {current_index, global_memory->AddString("@constructor"),
@@ -725,7 +734,7 @@ std::size_t HandleGlobalArrayDeclaration(Interpreter& interpreter,
       // Gets the corresponding array index reference.
       code.push_back(
           Bytecode{_AQVM_OPERATOR_ARRAY,
-                   {current_index, array_index, global_memory->AddUint64t(i)}});
+                   {current_index, array_index, MakeImmediate(i)}});
 
       // Gets the value of the initialization list and assigns value to
       // corresponding index.
@@ -800,7 +809,7 @@ std::size_t HandleStaticArrayDeclaration(Interpreter& interpreter,
     std::size_t current_index = global_memory->Add(1);
     global_code.push_back(
         Bytecode{_AQVM_OPERATOR_ARRAY,
-                 {current_index, array_index, global_memory->AddUint64t(0)}});
+                 {current_index, array_index, MakeImmediate(0)}});
     global_code.push_back(
         Bytecode{_AQVM_OPERATOR_INVOKE_METHOD,
                  {current_index, global_memory->AddString("@constructor"),
@@ -814,7 +823,7 @@ std::size_t HandleStaticArrayDeclaration(Interpreter& interpreter,
       // Gets the corresponding array index reference.
       global_code.push_back(
           Bytecode{_AQVM_OPERATOR_ARRAY,
-                   {current_index, array_index, global_memory->AddUint64t(i)}});
+                   {current_index, array_index, MakeImmediate(i)}});
 
       // Gets the value of the initialization list and assigns value to
       // corresponding index.
@@ -853,7 +862,8 @@ std::size_t HandleClassArrayDeclaration(Interpreter& interpreter,
   std::size_t array_index = global_memory->Add(1);
   code.push_back(
       Bytecode{_AQVM_OPERATOR_LOAD_MEMBER,
-               {3, array_index, 0, global_memory->AddString(variable_name)}});
+               {3, array_index, 0,
+                MakeImmediate(InternSymbol(variable_name))}});
   std::size_t array_type_index = 0;
 
   // Gets the sub type of the array type and its category.
@@ -891,7 +901,7 @@ std::size_t HandleClassArrayDeclaration(Interpreter& interpreter,
     std::size_t current_index = global_memory->Add(1);
     code.push_back(Bytecode{
         _AQVM_OPERATOR_ARRAY,
-        {3, current_index, array_index, global_memory->AddUint64t(0)}});
+        {3, current_index, array_index, MakeImmediate(0)}});
     code.push_back(
         Bytecode{_AQVM_OPERATOR_INVOKE_METHOD,
                  {3, current_index, global_memory->AddString("@constructor"),
@@ -905,7 +915,7 @@ std::size_t HandleClassArrayDeclaration(Interpreter& interpreter,
       std::size_t current_index = global_memory->Add(1);
       code.push_back(Bytecode{
           _AQVM_OPERATOR_ARRAY,
-          {3, current_index, array_index, global_memory->AddUint64t(i)}});
+          {3, current_index, array_index, MakeImmediate(i)}});
 
       // Gets the value of the initialization list and assigns value to
       // corresponding index.
@@ -925,7 +935,6 @@ void HandleFunctionArguments(Interpreter& interpreter,
                              std::vector<Bytecode>& code) {
   // Gets the reference of context.
   auto& scopes = interpreter.context.scopes;
-  auto& memory = interpreter.global_memory;
   auto& variables = interpreter.context.variables;
 
   // Gets the function statement and its parameters.
@@ -934,7 +943,7 @@ void HandleFunctionArguments(Interpreter& interpreter,
 
   // Handles functions that only contain variable parameters.
   if (parameters.size() == 0 && statement->IsVariadic()) {
-    std::size_t index = memory->Add(1);
+    std::size_t index = AddLocal(interpreter);
 
     // Adds index into |parameters_index| and |variables|.
     parameters_index.push_back(index);
@@ -975,7 +984,7 @@ void HandleFunctionArguments(Interpreter& interpreter,
 
     // Handles variable parameters if have.
     if (i == parameters.size() - 1 && statement->IsVariadic()) {
-      std::size_t index = memory->Add(1);
+      std::size_t index = AddLocal(interpreter);
 
       // Adds index into |parameters_index| and |variables|.
       parameters_index.push_back(index);
@@ -988,12 +997,11 @@ void HandleReturnInHandlingFunction(Interpreter& interpreter,
                                     std::vector<Bytecode>& code) {
   // Gets the reference of context.
   auto& exit_index = interpreter.context.function_context->exit_index;
-  auto& memory = interpreter.global_memory;
 
   code.push_back(Bytecode{_AQVM_OPERATOR_NOP, {}});
   std::size_t return_location = code.size();
   for (std::size_t i = 0; i < exit_index.size(); i++) {
-    code[exit_index[i]].arguments = {memory->AddUint64t(return_location)};
+    code[exit_index[i]].SetOperands({return_location});
   }
 }
 
@@ -1002,7 +1010,6 @@ void HandleGotoInHandlingFunction(Interpreter& interpreter,
                                   std::vector<Bytecode>& code) {
   // Gets the reference of context.
   auto& goto_map = interpreter.context.function_context->goto_map;
-  auto& memory = interpreter.global_memory;
   auto& scopes = interpreter.context.scopes;
   auto& label_map = interpreter.context.function_context->label_map;
 
@@ -1017,8 +1024,7 @@ void HandleGotoInHandlingFunction(Interpreter& interpreter,
       if (i == current_scope) LOGGING_ERROR("Label not found.");
     }
 
-    code[goto_map.back().second].arguments = {
-        memory->AddUint64t(goto_location)};
+    code[goto_map.back().second].SetOperands({goto_location});
     goto_map.pop_back();
   }
 }
@@ -1033,9 +1039,21 @@ void AddFunctionIntoList(Interpreter& interpreter,
 
   Ast::Function* statement = declaration->GetFunctionStatement();
 
+  uint8_t return_type = OptimizeFunction(interpreter, parameters_index, code);
+  AddInlineCandidate(interpreter, name, parameters_index, code,
+                     statement->IsVariadic());
   Function function(name, parameters_index, code);
+  if (interpreter.context.function_context != nullptr)
+    function.SetFrame(interpreter.context.function_context->frame);
   if (statement->IsVariadic()) function.EnableVariadic();
   functions[name].push_back(function);
+
+  auto iterator = interpreter.return_types.find(name);
+  if (iterator == interpreter.return_types.end()) {
+    interpreter.return_types[name] = return_type;
+  } else if (iterator->second != return_type) {
+    iterator->second = 0x00;
+  }
 }
 
 void AddClassFunctionIntoList(Interpreter& interpreter,
@@ -1049,7 +1067,10 @@ void AddClassFunctionIntoList(Interpreter& interpreter,
   std::string name = statement->GetFunctionName();
 
   // Adds function into class function list.
+  OptimizeFunction(interpreter, parameters_index, code);
   Function function(name, parameters_index, code);
+  if (interpreter.context.function_context != nullptr)
+    function.SetFrame(interpreter.context.function_context->frame);
   if (statement->IsVariadic()) function.EnableVariadic();
   methods[name].push_back(function);
 }
@@ -1063,6 +1084,7 @@ void AddClassConstructorFunctionIntoList(
   Ast::Function* statement = declaration->GetFunctionStatement();
 
   // Adds function into class function list.
+  OptimizeFunction(interpreter, parameters_index, code);
   Function function("@constructor", parameters_index, code);
   if (statement->IsVariadic()) function.EnableVariadic();
   methods["@constructor"].push_back(function);
@@ -1073,11 +1095,10 @@ void HandleReturnVariableInHandlingFunction(
     std::string scope_name, std::vector<std::size_t>& parameters_index) {
   // Gets the reference of context.
   auto& variables = interpreter.context.variables;
-  auto& memory = interpreter.global_memory;
 
   uint8_t vm_type = declaration->GetReturnType()->GetVmType();
-  variables[scope_name + "#!return"] = memory->AddWithType(vm_type);
-  variables[scope_name + "#!return_reference"] = memory->Add(1);
+  variables[scope_name + "#!return"] = AddLocal(interpreter, vm_type);
+  variables[scope_name + "#!return_reference"] = AddLocal(interpreter);
   parameters_index.push_back(variables[scope_name + "#!return_reference"]);
 }
 
@@ -1117,14 +1138,13 @@ std::vector<std::size_t> HandleFactoryFunctionInHandlingConstructor(
   // Builds the main part of the factory function.
   code.push_back(
       Bytecode{_AQVM_OPERATOR_NEW,
-               {return_index, memory->AddUint64t(0), memory->AddString(name)}});
+               {return_index, MakeImmediate(0), memory->AddString(name)}});
   std::vector<std::size_t> method_parameters = parameters_index;
   method_parameters.erase(method_parameters.begin());
   method_parameters.insert(
       method_parameters.begin(),
       {return_index, memory->AddString("@constructor"), memory->Add(1)});
-  code.push_back(
-      Bytecode{_AQVM_OPERATOR_INVOKE_METHOD, std::move(method_parameters)});
+  AppendBytecode(code, _AQVM_OPERATOR_INVOKE_METHOD, method_parameters);
 
   AddFunctionIntoList(interpreter, declaration, name, parameters_index, code);
 
@@ -1323,7 +1343,7 @@ std::vector<std::size_t> HandleVoidFactoryFunctionInHandlingClass(
   std::vector<Bytecode> code;
   code.push_back(Bytecode{
       _AQVM_OPERATOR_NEW,
-      {return_index, memory->AddUint64t(0), memory->AddString(class_name)}});
+      {return_index, MakeImmediate(0), memory->AddString(class_name)}});
   code.push_back(Bytecode{
       _AQVM_OPERATOR_INVOKE_METHOD,
       {return_index, memory->AddString("@constructor"), memory->Add(1)}});
@@ -1397,7 +1417,7 @@ void HandleClassInHandlingVariable(Interpreter& interpreter,
       // Format for NEW_MODULE: [result, size, type, module_ptr]
       // We'll store module_ptr in the bytecode for runtime access
       std::size_t type_index = memory->AddString(class_name);
-      std::size_t size_index = memory->AddByte(0);
+      std::size_t size_index = MakeImmediate(0);
       
       // Generate NEW_MODULE bytecode
       // The bytecode will create an object in the module interpreter,
@@ -1439,12 +1459,12 @@ class_found:
   // Adds the class into global memory.
   code.push_back(
       Bytecode{_AQVM_OPERATOR_NEW,
-               {variable_index, memory->AddByte(0), memory->AddString(name)}});
+               {variable_index, MakeImmediate(0), memory->AddString(name)}});
 
   // Classes without initialization requires default initialization.
   code.push_back(Bytecode{
       _AQVM_OPERATOR_INVOKE_METHOD,
-      {variable_index, memory->AddString("@constructor"), memory->Add(1)}});
+      {variable_index, memory->AddString("@constructor"), AddLocal(interpreter)}});
 }
 
 void HandleClassInHandlingVariableWithValue(Interpreter& interpreter,
@@ -1494,7 +1514,7 @@ class_found:
   // Adds the class into global memory.
   code.push_back(
       Bytecode{_AQVM_OPERATOR_NEW,
-               {variable_index, memory->AddByte(0), memory->AddString(name)}});
+               {variable_index, MakeImmediate(0), memory->AddString(name)}});
 }
 
 std::string GetClassNameString(Interpreter& interpreter, Ast::ClassType* type) {
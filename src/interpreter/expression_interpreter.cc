@@ -6,8 +6,10 @@
 
 #include "ast/ast.h"
 #include "interpreter/declaration_interpreter.h"
+#include "interpreter/frame.h"
 #include "interpreter/interpreter.h"
 #include "interpreter/operator.h"
+#include "interpreter/optimizer.h"
 #include "interpreter/statement_interpreter.h"
 #include "logging/logging.h"
 
@@ -63,7 +65,6 @@ std::size_t HandleUnaryExpression(Interpreter& interpreter,
   if (expression == nullptr) INTERNAL_ERROR("expression is nullptr.");
 
   // Get interpreter context references
-  auto global_memory = interpreter.global_memory;
   auto& scopes = interpreter.context.scopes;
 
   // First compile the operand expression
@@ -72,21 +73,22 @@ std::size_t HandleUnaryExpression(Interpreter& interpreter,
   
   // Allocate result storage if not provided
   std::size_t new_index =
-      result_index == 0 ? global_memory->Add(1) : result_index;
+      result_index == 0 ? AddLocal(interpreter) : result_index;
 
   // Generate bytecode based on the operator type
   switch (expression->GetOperator()) {
     case Ast::Unary::Operator::kPostInc: {  // x++ (postfix increment)
       code.push_back(
           Bytecode{_AQVM_OPERATOR_EQUAL, {new_index, sub_expression}});
-      if (global_memory->GetMemory()[sub_expression].type == 0x02) {
+      if (GetSlot(interpreter, sub_expression).type == 0x02) {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_ADDI,
-            {sub_expression, sub_expression, global_memory->AddLong(1)}});
-      } else if (global_memory->GetMemory()[sub_expression].type == 0x03) {
+            {sub_expression, sub_expression, AddIntLiteral(interpreter, 1)}});
+      } else if (GetSlot(interpreter, sub_expression).type == 0x03) {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_ADDF,
-            {sub_expression, sub_expression, global_memory->AddDouble(1.0)}});
+            {sub_expression, sub_expression,
+             AddFloatLiteral(interpreter, 1.0)}});
       } else {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_ADD,
@@ -98,14 +100,15 @@ std::size_t HandleUnaryExpression(Interpreter& interpreter,
     case Ast::Unary::Operator::kPostDec: {  // -- (postfix)
       code.push_back(
           Bytecode{_AQVM_OPERATOR_EQUAL, {new_index, sub_expression}});
-      if (global_memory->GetMemory()[sub_expression].type == 0x02) {
+      if (GetSlot(interpreter, sub_expression).type == 0x02) {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_SUBI,
-            {sub_expression, sub_expression, global_memory->AddLong(1)}});
-      } else if (global_memory->GetMemory()[sub_expression].type == 0x03) {
+            {sub_expression, sub_expression, AddIntLiteral(interpreter, 1)}});
+      } else if (GetSlot(interpreter, sub_expression).type == 0x03) {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_SUBF,
-            {sub_expression, sub_expression, global_memory->AddDouble(1.0)}});
+            {sub_expression, sub_expression,
+             AddFloatLiteral(interpreter, 1.0)}});
       } else {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_SUB,
@@ -115,14 +118,15 @@ std::size_t HandleUnaryExpression(Interpreter& interpreter,
     }
 
     case Ast::Unary::Operator::kPreInc:  // ++ (prefix)
-      if (global_memory->GetMemory()[sub_expression].type == 0x02) {
+      if (GetSlot(interpreter, sub_expression).type == 0x02) {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_ADDI,
-            {sub_expression, sub_expression, global_memory->AddLong(1)}});
-      } else if (global_memory->GetMemory()[sub_expression].type == 0x03) {
+            {sub_expression, sub_expression, AddIntLiteral(interpreter, 1)}});
+      } else if (GetSlot(interpreter, sub_expression).type == 0x03) {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_ADDF,
-            {sub_expression, sub_expression, global_memory->AddDouble(1.0)}});
+            {sub_expression, sub_expression,
+             AddFloatLiteral(interpreter, 1.0)}});
       } else {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_ADD,
@@ -131,14 +135,15 @@ std::size_t HandleUnaryExpression(Interpreter& interpreter,
       return sub_expression;
 
     case Ast::Unary::Operator::kPreDec:  // -- (prefix)
-      if (global_memory->GetMemory()[sub_expression].type == 0x02) {
+      if (GetSlot(interpreter, sub_expression).type == 0x02) {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_SUBI,
-            {sub_expression, sub_expression, global_memory->AddLong(1)}});
-      } else if (global_memory->GetMemory()[sub_expression].type == 0x03) {
+            {sub_expression, sub_expression, AddIntLiteral(interpreter, 1)}});
+      } else if (GetSlot(interpreter, sub_expression).type == 0x03) {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_SUBF,
-            {sub_expression, sub_expression, global_memory->AddDouble(1.0)}});
+            {sub_expression, sub_expression,
+             AddFloatLiteral(interpreter, 1.0)}});
       } else {
         code.push_back(Bytecode{
             _AQVM_OPERATOR_SUB,
@@ -182,9 +187,6 @@ std::size_t HandleBinaryExpression(Interpreter& interpreter,
                                    std::size_t result_index) {
   if (expression == nullptr) INTERNAL_ERROR("expression is nullptr.");
 
-  // Gets the reference of context.
-  auto global_memory = interpreter.global_memory;
-
   // Gets the reference of expressions.
   Ast::Expression* right_expression = expression->GetRightExpression();
   Ast::Expression* left_expression = expression->GetLeftExpression();
@@ -198,10 +200,10 @@ std::size_t HandleBinaryExpression(Interpreter& interpreter,
     left = HandleExpression(interpreter, left_expression, code, 0);
   }
 
-  uint8_t type = global_memory->GetMemory()[left].type >
-                         global_memory->GetMemory()[right].type
-                     ? global_memory->GetMemory()[left].type
-                     : global_memory->GetMemory()[right].type;
+  uint8_t type = GetSlot(interpreter, left).type >
+                         GetSlot(interpreter, right).type
+                     ? GetSlot(interpreter, left).type
+                     : GetSlot(interpreter, right).type;
 
   if (expression->GetOperator() == Ast::Binary::Operator::kLT ||
       expression->GetOperator() == Ast::Binary::Operator::kGT ||
@@ -212,16 +214,16 @@ std::size_t HandleBinaryExpression(Interpreter& interpreter,
     type = 0;
 
   std::size_t result =
-      result_index == 0 ? global_memory->AddWithType(type) : result_index;
+      result_index == 0 ? AddLocal(interpreter, type) : result_index;
   switch (expression->GetOperator()) {
     case Ast::Binary::Operator::kAdd:  // +
-      if (global_memory->GetMemory()[result].type == 0x02 &&
-          global_memory->GetMemory()[left].type == 0x02 &&
-          global_memory->GetMemory()[right].type == 0x02) {
+      if (GetSlot(interpreter, result).type == 0x02 &&
+          GetSlot(interpreter, left).type == 0x02 &&
+          GetSlot(interpreter, right).type == 0x02) {
         code.push_back(Bytecode{_AQVM_OPERATOR_ADDI, {result, left, right}});
-      } else if (global_memory->GetMemory()[result].type == 0x03 &&
-                 global_memory->GetMemory()[left].type == 0x03 &&
-                 global_memory->GetMemory()[right].type == 0x03) {
+      } else if (GetSlot(interpreter, result).type == 0x03 &&
+                 GetSlot(interpreter, left).type == 0x03 &&
+                 GetSlot(interpreter, right).type == 0x03) {
         code.push_back(Bytecode{_AQVM_OPERATOR_ADDF, {result, left, right}});
       } else {
         code.push_back(Bytecode{_AQVM_OPERATOR_ADD, {result, left, right}});
@@ -230,13 +232,13 @@ std::size_t HandleBinaryExpression(Interpreter& interpreter,
       return result;
 
     case Ast::Binary::Operator::kSub:  // -
-      if (global_memory->GetMemory()[result].type == 0x02 &&
-          global_memory->GetMemory()[left].type == 0x02 &&
-          global_memory->GetMemory()[right].type == 0x02) {
+      if (GetSlot(interpreter, result).type == 0x02 &&
+          GetSlot(interpreter, left).type == 0x02 &&
+          GetSlot(interpreter, right).type == 0x02) {
         code.push_back(Bytecode{_AQVM_OPERATOR_SUBI, {result, left, right}});
-      } else if (global_memory->GetMemory()[result].type == 0x03 &&
-                 global_memory->GetMemory()[left].type == 0x03 &&
-                 global_memory->GetMemory()[right].type == 0x03) {
+      } else if (GetSlot(interpreter, result).type == 0x03 &&
+                 GetSlot(interpreter, left).type == 0x03 &&
+                 GetSlot(interpreter, right).type == 0x03) {
         code.push_back(Bytecode{_AQVM_OPERATOR_SUBF, {result, left, right}});
       } else {
         code.push_back(Bytecode{_AQVM_OPERATOR_SUB, {result, left, right}});
@@ -244,13 +246,13 @@ std::size_t HandleBinaryExpression(Interpreter& interpreter,
       return result;
 
     case Ast::Binary::Operator::kMul:  // *
-      if (global_memory->GetMemory()[result].type == 0x02 &&
-          global_memory->GetMemory()[left].type == 0x02 &&
-          global_memory->GetMemory()[right].type == 0x02) {
+      if (GetSlot(interpreter, result).type == 0x02 &&
+          GetSlot(interpreter, left).type == 0x02 &&
+          GetSlot(interpreter, right).type == 0x02) {
         code.push_back(Bytecode{_AQVM_OPERATOR_MULI, {result, left, right}});
-      } else if (global_memory->GetMemory()[result].type == 0x03 &&
-                 global_memory->GetMemory()[left].type == 0x03 &&
-                 global_memory->GetMemory()[right].type == 0x03) {
+      } else if (GetSlot(interpreter, result).type == 0x03 &&
+                 GetSlot(interpreter, left).type == 0x03 &&
+                 GetSlot(interpreter, right).type == 0x03) {
         code.push_back(Bytecode{_AQVM_OPERATOR_MULF, {result, left, right}});
       } else {
         code.push_back(Bytecode{_AQVM_OPERATOR_MUL, {result, left, right}});
@@ -258,13 +260,13 @@ std::size_t HandleBinaryExpression(Interpreter& interpreter,
       return result;
 
     case Ast::Binary::Operator::kDiv:  // /
-      if (global_memory->GetMemory()[result].type == 0x02 &&
-          global_memory->GetMemory()[left].type == 0x02 &&
-          global_memory->GetMemory()[right].type == 0x02) {
+      if (GetSlot(interpreter, result).type == 0x02 &&
+          GetSlot(interpreter, left).type == 0x02 &&
+          GetSlot(interpreter, right).type == 0x02) {
         code.push_back(Bytecode{_AQVM_OPERATOR_DIVI, {result, left, right}});
-      } else if (global_memory->GetMemory()[result].type == 0x03 &&
-                 global_memory->GetMemory()[left].type == 0x03 &&
-                 global_memory->GetMemory()[right].type == 0x03) {
+      } else if (GetSlot(interpreter, result).type == 0x03 &&
+                 GetSlot(interpreter, left).type == 0x03 &&
+                 GetSlot(interpreter, right).type == 0x03) {
         code.push_back(Bytecode{_AQVM_OPERATOR_DIVF, {result, left, right}});
       } else {
         code.push_back(Bytecode{_AQVM_OPERATOR_DIV, {result, left, right}});
@@ -272,9 +274,9 @@ std::size_t HandleBinaryExpression(Interpreter& interpreter,
       return result;
 
     case Ast::Binary::Operator::kRem:  // %
-      if (global_memory->GetMemory()[result].type == 0x02 &&
-          global_memory->GetMemory()[left].type == 0x02 &&
-          global_memory->GetMemory()[right].type == 0x02) {
+      if (GetSlot(interpreter, result).type == 0x02 &&
+          GetSlot(interpreter, left).type == 0x02 &&
+          GetSlot(interpreter, right).type == 0x02) {
         code.push_back(Bytecode{_AQVM_OPERATOR_REMI, {result, left, right}});
       } else {
         code.push_back(Bytecode{_AQVM_OPERATOR_REM, {result, left, right}});
@@ -472,9 +474,9 @@ std::size_t HandlePeriodExpression(Interpreter& interpreter,
         if (is_constructor && func_expr->GetParameters().empty()) {
           // This is a module class constructor call: module.ClassName()
           // Use NEW_MODULE bytecode (which also calls the constructor internally)
-          std::size_t return_value_index = global_memory->Add(1);
+          std::size_t return_value_index = AddLocal(interpreter);
           std::size_t type_index = global_memory->AddString(method_name);
-          std::size_t size_index = global_memory->AddByte(0);
+          std::size_t size_index = MakeImmediate(0);
           
           // Generate NEW_MODULE bytecode
           // Constructor is called automatically inside NEW_MODULE
@@ -502,7 +504,8 @@ std::size_t HandlePeriodExpression(Interpreter& interpreter,
         }
         
         // Use INVOKE_MODULE_METHOD for cross-module function calls
-        code.push_back(Bytecode{_AQVM_OPERATOR_INVOKE_MODULE_METHOD, std::move(invoke_args)});
+        AppendBytecode(code, _AQVM_OPERATOR_INVOKE_MODULE_METHOD,
+                       invoke_args);
         
         return return_value_index;
       }
@@ -510,7 +513,7 @@ std::size_t HandlePeriodExpression(Interpreter& interpreter,
         // This is a module variable access: module.variable
         std::string member_name = std::string(*Ast::Cast<Ast::Identifier>(expressions[1]));
         
-        std::size_t return_value_index = global_memory->Add(1);
+        std::size_t return_value_index = AddLocal(interpreter);
         std::size_t member_name_index = global_memory->AddString(member_name);
         
         // Use LOAD_MODULE_MEMBER for cross-module variable access
@@ -578,8 +581,7 @@ std::size_t HandlePeriodExpression(Interpreter& interpreter,
             invoke_arguments.push_back(
                 HandleExpression(interpreter, arguments[i], code, 0));
 
-          code.push_back(Bytecode{_AQVM_OPERATOR_INVOKE_METHOD,
-                                  std::move(invoke_arguments)});
+          AppendBytecode(code, _AQVM_OPERATOR_INVOKE_METHOD, invoke_arguments);
           return return_value_index;
         }
       }
@@ -629,19 +631,18 @@ std::size_t HandlePeriodExpression(Interpreter& interpreter,
         invoke_arguments.push_back(
             HandleExpression(interpreter, arguments[i], code, 0));
 
-      code.push_back(
-          Bytecode{_AQVM_OPERATOR_INVOKE_METHOD, std::move(invoke_arguments)});
+      AppendBytecode(code, _AQVM_OPERATOR_INVOKE_METHOD, invoke_arguments);
       return return_value_index;
     }
 
     case Ast::Statement::StatementType::kIdentifier: {
-      std::size_t return_value_index = global_memory->Add(1);
+      std::size_t return_value_index = AddLocal(interpreter);
 
       // Handles the class and variable name.
       std::size_t class_index = HandleExpression(
           interpreter, expression->GetLeftExpression(), code, 0);
-      std::size_t variable_name_index = global_memory->AddString(std::string(
-          *Ast::Cast<Ast::Identifier>(expression->GetRightExpression())));
+      std::size_t variable_name_index = MakeImmediate(InternSymbol(std::string(
+          *Ast::Cast<Ast::Identifier>(expression->GetRightExpression()))));
 
       code.push_back(
           Bytecode{_AQVM_OPERATOR_LOAD_MEMBER,
@@ -696,20 +697,19 @@ std::size_t HandleFunctionInvoke(Interpreter& interpreter,
     // Create a new instance of the class using NEW operator.
     code.push_back(
         Bytecode{_AQVM_OPERATOR_NEW,
-                 {return_value_index, global_memory->AddByte(0),
+                 {return_value_index, MakeImmediate(0),
                   global_memory->AddString(class_name_to_check)}});
 
     // Call the constructor with the provided arguments.
     // Constructors are stored with the special name "@constructor".
     std::vector<std::size_t> constructor_arguments{
         return_value_index, global_memory->AddString("@constructor"),
-        global_memory->Add(1)};
+        AddLocal(interpreter)};
     for (std::size_t i = 0; i < arguments.size(); i++)
       constructor_arguments.push_back(
           HandleExpression(interpreter, arguments[i], code, 0));
 
-    code.push_back(Bytecode{_AQVM_OPERATOR_INVOKE_METHOD,
-                            std::move(constructor_arguments)});
+    AppendBytecode(code, _AQVM_OPERATOR_INVOKE_METHOD, constructor_arguments);
 
     return return_value_index;
   }
@@ -780,22 +780,18 @@ std::size_t HandleFunctionInvoke(Interpreter& interpreter,
     vm_arguments.push_back(
         HandleExpression(interpreter, arguments[i], code, 0));
 
-  code.push_back(
-      Bytecode{_AQVM_OPERATOR_INVOKE_METHOD, std::move(vm_arguments)});
+  AppendBytecode(code, _AQVM_OPERATOR_INVOKE_METHOD, vm_arguments);
 
   return return_value_index;
 }
 
 std::size_t AddConstInt8t(Interpreter& interpreter, int8_t value) {
-  return interpreter.global_memory->AddByte(value);
+  return AddIntLiteral(interpreter, value);
 }
 
 std::size_t HandleFunctionReturnValue(Interpreter& interpreter,
                                       std::vector<Bytecode>& code) {
-  // Gets the reference of context.
-  auto global_memory = interpreter.global_memory;
-
-  std::size_t return_value_index = global_memory->Add(1);
+  std::size_t return_value_index = AddLocal(interpreter);
 
   return return_value_index;
 }
@@ -843,18 +839,18 @@ std::size_t GetIndex(Interpreter& interpreter, Ast::Expression* expression,
       switch (vm_type) {
         case 0x01: {
           int8_t value = Ast::Cast<Ast::Value>(expression)->GetByteValue();
-          return global_memory->AddByte(value);
+          return AddIntLiteral(interpreter, value);
           break;
         }
 
         case 0x02: {
           int64_t value = Ast::Cast<Ast::Value>(expression)->GetLongValue();
-          return global_memory->AddLong(value);
+          return AddIntLiteral(interpreter, value);
         }
 
         case 0x03: {
           double value = Ast::Cast<Ast::Value>(expression)->GetDoubleValue();
-          return global_memory->AddDouble(value);
+          return AddFloatLiteral(interpreter, value);
         }
 
         case 0x04: {
@@ -916,10 +912,10 @@ std::size_t GetClassIndex(Interpreter& interpreter, Ast::Expression* expression,
       if (current_class != nullptr && current_class->GetName() != ".!__start" &&
           current_class->GetVariable(variable_name, temp)) {
         // Gets the reference of the variable index.
-        std::size_t return_index = global_memory->Add(1);
+        std::size_t return_index = AddLocal(interpreter);
         code.push_back(Bytecode{
             _AQVM_OPERATOR_LOAD_MEMBER,
-            {return_index, 0, global_memory->AddString(variable_name)}});
+            {return_index, 0, MakeImmediate(InternSymbol(variable_name))}});
         return return_index;
       }
 
@@ -942,18 +938,18 @@ std::size_t GetClassIndex(Interpreter& interpreter, Ast::Expression* expression,
       switch (vm_type) {
         case 0x01: {
           int8_t value = Ast::Cast<Ast::Value>(expression)->GetByteValue();
-          return global_memory->AddByte(value);
+          return AddIntLiteral(interpreter, value);
           break;
         }
 
         case 0x02: {
           int64_t value = Ast::Cast<Ast::Value>(expression)->GetLongValue();
-          return global_memory->AddLong(value);
+          return AddIntLiteral(interpreter, value);
         }
 
         case 0x03: {
           double value = Ast::Cast<Ast::Value>(expression)->GetDoubleValue();
-          return global_memory->AddDouble(value);
+          return AddFloatLiteral(interpreter, value);
         }
 
         case 0x04: {
@@ -1002,6 +998,7 @@ std::size_t HandleLambdaExpression(Interpreter& interpreter,
   // Save current function context
   FunctionContext* saved_context = interpreter.context.function_context;
   FunctionContext new_context;
+  new_context.has_frame = CanUseFrame(lambda->GetBody());
   interpreter.context.function_context = &new_context;
 
   // Create a new scope for the lambda
@@ -1014,16 +1011,15 @@ std::size_t HandleLambdaExpression(Interpreter& interpreter,
 
   // Add return value reference as first parameter (like regular functions)
   uint8_t return_vm_type = lambda->GetReturnType()->GetVmType();
-  variables[lambda_scope + "#!return"] = global_memory->AddWithType(return_vm_type);
-  variables[lambda_scope + "#!return_reference"] = global_memory->Add(1);
+  variables[lambda_scope + "#!return"] = AddLocal(interpreter, return_vm_type);
+  variables[lambda_scope + "#!return_reference"] = AddLocal(interpreter);
   parameters_index.push_back(variables[lambda_scope + "#!return_reference"]);
 
   for (auto param : lambda->GetParameters()) {
-    Ast::Type* param_type = param->GetVariableType();
     std::string param_name = param->GetVariableName();
     
     // Add parameter to variables
-    std::size_t param_index = global_memory->Add(param_type->GetVmType());
+    std::size_t param_index = AddLocal(interpreter);
     variables[lambda_scope + "#" + param_name] = param_index;
     parameters_index.push_back(param_index);
   }
@@ -1040,6 +1036,7 @@ std::size_t HandleLambdaExpression(Interpreter& interpreter,
 
   // Create function object - store it in current class methods
   Function lambda_func(lambda_name, parameters_index, lambda_code);
+  lambda_func.SetFrame(new_context.frame);
   if (lambda->IsVariadic()) {
     lambda_func.EnableVariadic();
   }
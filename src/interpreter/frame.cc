@@ -0,0 +1,117 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#include "interpreter/frame.h"
+
+#include "logging/logging.h"
+
+namespace Aq {
+namespace Interpreter {
+bool CanUseFrame(Ast::Statement* body) {
+  if (body == nullptr) return true;
+
+  switch (body->GetStatementType()) {
+    case Ast::Statement::StatementType::kLambda:
+    case Ast::Statement::StatementType::kFunctionDeclaration:
+    case Ast::Statement::StatementType::kClass:
+      return false;
+
+    case Ast::Statement::StatementType::kCompound:
+      for (auto statement : Ast::Cast<Ast::Compound>(body)->GetStatements())
+        if (!CanUseFrame(statement)) return false;
+      return true;
+
+    case Ast::Statement::StatementType::kCase:
+      for (auto statement : Ast::Cast<Ast::Case>(body)->GetStatements())
+        if (!CanUseFrame(statement)) return false;
+      return CanUseFrame(Ast::Cast<Ast::Case>(body)->GetCaseExpression());
+
+    case Ast::Statement::StatementType::kIf: {
+      auto statement = Ast::Cast<Ast::If>(body);
+      return CanUseFrame(statement->GetConditionExpression()) &&
+             CanUseFrame(statement->GetIfBody()) &&
+             CanUseFrame(statement->GetElseBody());
+    }
+
+    case Ast::Statement::StatementType::kWhile: {
+      auto statement = Ast::Cast<Ast::While>(body);
+      return CanUseFrame(statement->GetConditionExpression()) &&
+             CanUseFrame(statement->GetWhileBody());
+    }
+
+    case Ast::Statement::StatementType::kDowhile: {
+      auto statement = Ast::Cast<Ast::DoWhile>(body);
+      return CanUseFrame(statement->GetConditionExpression()) &&
+             CanUseFrame(statement->GetDoWhileBody());
+    }
+
+    case Ast::Statement::StatementType::kFor: {
+      auto statement = Ast::Cast<Ast::For>(body);
+      return CanUseFrame(statement->GetStartExpression()) &&
+             CanUseFrame(statement->GetConditionExpression()) &&
+             CanUseFrame(statement->GetEndExpression()) &&
+             CanUseFrame(statement->GetForBody());
+    }
+
+    case Ast::Statement::StatementType::kReturn:
+      return CanUseFrame(Ast::Cast<Ast::Return>(body)->GetExpression());
+
+    case Ast::Statement::StatementType::kStatic:
+      return CanUseFrame(
+          Ast::Cast<Ast::Static>(body)->GetStaticDeclaration());
+
+    case Ast::Statement::StatementType::kUnary:
+      return CanUseFrame(Ast::Cast<Ast::Unary>(body)->GetExpression());
+
+    case Ast::Statement::StatementType::kArray:
+      return CanUseFrame(Ast::Cast<Ast::Array>(body)->GetExpression()) &&
+             CanUseFrame(Ast::Cast<Ast::Array>(body)->GetIndexExpression());
+
+    case Ast::Statement::StatementType::kBinary:
+      return CanUseFrame(Ast::Cast<Ast::Binary>(body)->GetLeftExpression()) &&
+             CanUseFrame(Ast::Cast<Ast::Binary>(body)->GetRightExpression());
+
+    case Ast::Statement::StatementType::kConditional: {
+      auto expression = Ast::Cast<Ast::Conditional>(body);
+      return CanUseFrame(expression->GetConditionExpression()) &&
+             CanUseFrame(expression->GetTrueExpression()) &&
+             CanUseFrame(expression->GetFalseExpression());
+    }
+
+    case Ast::Statement::StatementType::kFunction:
+      for (auto parameter : Ast::Cast<Ast::Function>(body)->GetParameters())
+        if (!CanUseFrame(parameter)) return false;
+      return true;
+
+    case Ast::Statement::StatementType::kVariable:
+    case Ast::Statement::StatementType::kArrayDeclaration:
+      for (auto value : Ast::Cast<Ast::Variable>(body)->GetVariableValue())
+        if (!CanUseFrame(value)) return false;
+      return true;
+
+    default:
+      return true;
+  }
+}
+
+std::size_t AddLocal(Interpreter& interpreter, uint8_t type) {
+  auto function_context = interpreter.context.function_context;
+  if (function_context == nullptr || !function_context->has_frame)
+    return interpreter.global_memory->AddWithType(type);
+
+  function_context->frame.push_back({type, type != 0x00, {}});
+  return (function_context->frame.size() - 1) | kFrameOperandFlag;
+}
+
+Object& GetSlot(Interpreter& interpreter, std::size_t index) {
+  if (!IsFrameOperand(index)) return interpreter.global_memory->GetMemory()[index];
+
+  auto function_context = interpreter.context.function_context;
+  if (function_context == nullptr || !function_context->has_frame)
+    INTERNAL_ERROR("Frame operand outside of a framed function.");
+
+  return function_context->frame[index & ~kFrameOperandFlag];
+}
+}  // namespace Interpreter
+}  // namespace Aq
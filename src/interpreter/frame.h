@@ -0,0 +1,33 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#ifndef AQ_INTERPRETER_FRAME_H_
+#define AQ_INTERPRETER_FRAME_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ast/ast.h"
+#include "interpreter/interpreter.h"
+#include "interpreter/memory.h"
+
+namespace Aq {
+namespace Interpreter {
+// Returns true if the locals of a function with |body| can live in an
+// activation frame. Bodies that declare lambdas, functions or classes can
+// capture the locals by their slots, so they keep absolute slots.
+bool CanUseFrame(Ast::Statement* body);
+
+// Allocates a slot with |type| for a local variable or temporary of the
+// function being generated. Returns a frame operand if the function has an
+// activation frame and an index into the global memory otherwise.
+std::size_t AddLocal(Interpreter& interpreter, uint8_t type = 0x00);
+
+// Gets the compile-time object of the slot addressed by |index|, which is
+// either a frame operand of the function being generated or a global index.
+Object& GetSlot(Interpreter& interpreter, std::size_t index);
+}  // namespace Interpreter
+}  // namespace Aq
+
+#endif
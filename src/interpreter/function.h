@@ -5,14 +5,49 @@
 #ifndef AQ_INTERPRETER_FUNCTION_H_
 #define AQ_INTERPRETER_FUNCTION_H_
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "interpreter/bytecode.h"
+#include "interpreter/memory.h"
 
 namespace Aq {
 namespace Interpreter {
+class Function;
+
+// The number of receiver classes and argument types an inline cache holds
+// before the call site is treated as megamorphic.
+constexpr std::size_t kInlineCacheSize = 4;
+
+// A method that a call site resolved to for one receiver class.
+struct InlineCacheEntry {
+  // The @name string of the receiver class. It is shared by all instances of
+  // the class, so it identifies the class.
+  const String* receiver_class = nullptr;
+
+  // Whether the method is overloaded, in which case the entry only applies to
+  // arguments of the types in |signature|, 8 bits for each.
+  bool has_signature = false;
+  uint64_t signature = 0;
+
+  Function* method = nullptr;
+};
+
+// The inline cache of an INVOKE_METHOD call site. It remembers whether the
+// called name is a builtin function and which methods it resolved to, so that
+// repeated calls skip the lookups by name and the overload selection.
+struct InlineCache {
+  // The name string the cache was filled for. The entries are dropped if the
+  // call site names another method.
+  const String* name = nullptr;
+  std::function<int(Memory*, std::vector<std::size_t>)>* builtin = nullptr;
+
+  std::size_t size = 0;
+  InlineCacheEntry entries[kInlineCacheSize];
+};
+
 class Function {
  public:
   Function() = default;
@@ -21,14 +56,32 @@ class Function {
     name_ = name;
     parameters_ = parameters;
     code_ = code;
+    FuseSuperinstructions(code_);
+    SpecializeElementAccess(code_);
   }
   ~Function() = default;
 
   std::string GetName() { return name_; }
 
-  std::vector<std::size_t> GetParameters() { return parameters_; }
+  std::vector<std::size_t>& GetParameters() { return parameters_; }
+
+  // Gets the code of the function. The interpreter runs the code directly
+  // and quickens instructions in place, so the changes are shared by all
+  // invocations.
+  std::vector<Bytecode>& GetCode() { return code_; }
+
+  // Gets the template of the activation frame of the function. Frame operands
+  // in the code and parameters address slots of a copy of this template that
+  // is pushed on every invocation. An empty frame means that the function
+  // only uses absolute slots.
+  std::vector<Object>& GetFrame() { return frame_; }
+
+  void SetFrame(const std::vector<Object>& frame) { frame_ = frame; }
 
-  std::vector<Bytecode> GetCode() { return code_; }
+  // Gets the inline cache of the INVOKE_METHOD at |position| in the code.
+  InlineCache& GetInlineCache(std::size_t position) {
+    return inline_caches_[position];
+  }
 
   void EnableVariadic() { is_variadic_ = true; }
 
@@ -38,6 +91,8 @@ class Function {
   std::string name_;
   std::vector<std::size_t> parameters_;
   std::vector<Bytecode> code_;
+  std::vector<Object> frame_;
+  std::unordered_map<std::size_t, InlineCache> inline_caches_;
   bool is_variadic_ = false;
 };
 
@@ -47,6 +102,19 @@ struct FunctionContext {
   std::size_t current_scope = 0;
   std::vector<std::size_t> exit_index;
   std::vector<int64_t> loop_break_index;
+
+  // Whether locals and temporaries of the function are allocated in its
+  // activation frame, and the template of that frame.
+  bool has_frame = false;
+  std::vector<Object> frame;
+};
+
+// The optimized code of a small function, which the optimizer copies into
+// the functions that call it instead of calling it.
+struct InlineCandidate {
+  std::vector<std::size_t> parameters;
+  std::vector<Object> frame;
+  std::vector<Bytecode> code;
 };
 }  // namespace Interpreter
 }  // namespace Aq
@@ -38,7 +38,6 @@ void HandleGoto(Interpreter& interpreter, Ast::Goto* label,
   auto& label_map = interpreter.context.function_context->label_map;
   auto& current_scope = interpreter.context.function_context->current_scope;
   auto& goto_map = interpreter.context.function_context->goto_map;
-  auto& global_memory = interpreter.global_memory;
 
   std::string label_name = std::string(label->GetLabel());
 
@@ -48,7 +47,7 @@ void HandleGoto(Interpreter& interpreter, Ast::Goto* label,
     // If the label is found in the current scope,
     // it will be replaced with the address of the label.
     if (iterator != label_map.end()) {
-      code.push_back(Bytecode{_AQVM_OPERATOR_GOTO, {global_memory->AddUint64t(iterator->second)}});
+      code.push_back(Bytecode{_AQVM_OPERATOR_GOTO, {iterator->second}});
       return;
     }
 
@@ -11,7 +11,9 @@
 #include "interpreter/declaration_interpreter.h"
 #include "interpreter/goto_interpreter.h"
 #include "interpreter/operator.h"
+#include "interpreter/optimizer.h"
 #include "interpreter/preprocesser.h"
+#include "interpreter/simd.h"
 #include "interpreter/statement_interpreter.h"
 #include "logging/logging.h"
 #include "memory.h"
@@ -142,8 +144,8 @@ void Interpreter::Generate(Ast::Compound* statement) {
       if (i == 0) LOGGING_ERROR("Label not found.");
     }
 
-    global_code[context.function_context->goto_map.back().second].arguments = {
-        1, global_memory->AddUint64t(goto_location)};
+    global_code[context.function_context->goto_map.back().second].SetOperands(
+        {goto_location});
     context.function_context->goto_map.pop_back();
   }
 
@@ -159,8 +161,8 @@ void Interpreter::Generate(Ast::Compound* statement) {
   // Adds the start function name into the constructor arguments. And makes the
   // invoke for the start function.
   std::vector<std::size_t> invoke_start_arguments = {2, start_function_name, 1};
-  start_code.push_back(Bytecode{_AQVM_OPERATOR_INVOKE_METHOD,
-                                std::move(invoke_start_arguments)});
+  AppendBytecode(start_code, _AQVM_OPERATOR_INVOKE_METHOD,
+                 invoke_start_arguments);
 
   // Makes the constructor function for the start function.
   Function constructor_func("@constructor", constructor_args, start_code);
@@ -173,8 +175,8 @@ void Interpreter::Generate(Ast::Compound* statement) {
   // Adds the main function invoke into the global code.
   std::size_t main_func = global_memory->AddString(".main");
   std::vector<std::size_t> invoke_main_arguments = {2, main_func, 1};
-  global_code.push_back(
-      Bytecode{_AQVM_OPERATOR_INVOKE_METHOD, std::move(invoke_main_arguments)});
+  AppendBytecode(global_code, _AQVM_OPERATOR_INVOKE_METHOD,
+                 invoke_main_arguments);
   Function start_func(".!__start", arguments, global_code);
   functions[".!__start"].push_back(start_func);
 
@@ -213,6 +215,87 @@ void Interpreter::Run() {
   std::chrono::duration<double, std::milli> duration = end_time - start_time;
   LOGGING_INFO("Interpreter ran for " + std::to_string(duration.count()) +
                " ms.");
+  if (!print_stats) return;
+
+  std::size_t code_size = 0;
+  for (auto& class_pair : classes)
+    for (auto& method_pair : class_pair.second.GetMethods())
+      for (auto& method : method_pair.second)
+        code_size += method.GetCode().size();
+  LOGGING_INFO("Code size of the class methods is " +
+               std::to_string(code_size) + " words (" +
+               std::to_string(code_size * sizeof(Bytecode)) + " bytes).");
+  const OptimizerStats& optimizer_stats = GetOptimizerStats();
+  LOGGING_INFO("Optimized " +
+               std::to_string(optimizer_stats.optimized_function_count) +
+               " functions at -O" + std::to_string(GetOptimizationLevel()) +
+               ": folded " + std::to_string(optimizer_stats.folded_count) +
+               " constants and " +
+               std::to_string(optimizer_stats.folded_branch_count) +
+               " branches, propagated " +
+               std::to_string(optimizer_stats.propagated_count) +
+               " values, coalesced " +
+               std::to_string(optimizer_stats.coalesced_count) +
+               " copies, removed " +
+               std::to_string(optimizer_stats.dead_store_count) +
+               " dead stores and " +
+               std::to_string(optimizer_stats.unreachable_count) +
+               " unreachable instructions.");
+  LOGGING_INFO("Inferred the types of " +
+               std::to_string(optimizer_stats.inferred_slot_count) +
+               " slots and specialized " +
+               std::to_string(optimizer_stats.specialized_count) +
+               " instructions.");
+  LOGGING_INFO("Inlined " +
+               std::to_string(optimizer_stats.inlined_call_count) +
+               " calls.");
+  LOGGING_INFO("Threaded " +
+               std::to_string(optimizer_stats.threaded_jump_count) +
+               " jumps, removed " +
+               std::to_string(optimizer_stats.removed_nop_count) +
+               " NOPs and " +
+               std::to_string(optimizer_stats.removed_jump_count) +
+               " jumps to the next instruction.");
+  LOGGING_INFO("Packed frames by " +
+               std::to_string(optimizer_stats.packed_slot_count) + " slots.");
+  LOGGING_INFO("Quickened " + std::to_string(quickened_instruction_count) +
+               " instructions, " +
+               std::to_string(deoptimized_instruction_count) +
+               " deoptimized.");
+  LOGGING_INFO("Fused " + std::to_string(fused_instruction_count) +
+               " superinstructions.");
+  LOGGING_INFO("Specialized " +
+               std::to_string(specialized_element_access_count) +
+               " array accesses, packed " +
+               std::to_string(packed_array_count) + " arrays, unpacked " +
+               std::to_string(unpacked_array_count) + ".");
+  LOGGING_INFO("Array kernels run on " +
+               std::string(GetSimdLevelName(GetSimdLevel())) + ".");
+  for (const auto& stats : GetAllocationStats())
+    LOGGING_INFO("Allocated " + std::to_string(stats.allocation_count) + " " +
+                 stats.name + " (" +
+                 std::to_string(stats.heap_allocation_count) +
+                 " from the heap, " + std::to_string(stats.allocated_bytes) +
+                 " bytes), freed " + std::to_string(stats.deallocation_count) +
+                 ".");
+  const CollectorStats& collector_stats = GetCollectorStats();
+  LOGGING_INFO("Collected garbage " +
+               std::to_string(collector_stats.collection_count) +
+               " times, freed " +
+               std::to_string(collector_stats.collected_object_count) +
+               " objects (" + std::to_string(collector_stats.collected_bytes) +
+               " bytes), paused " +
+               std::to_string(collector_stats.total_pause) + " ms, longest " +
+               std::to_string(collector_stats.max_pause) + " ms.");
+  LOGGING_INFO("Inline caches answered " +
+               std::to_string(inline_cache_hit_count) + " of " +
+               std::to_string(inline_cache_hit_count + inline_cache_miss_count) +
+               " call site lookups.");
+  LOGGING_INFO("Invoked " + std::to_string(invoked_method_count) +
+               " methods (" +
+               std::to_string(invoked_method_count / duration.count()) +
+               " per ms), max call depth " + std::to_string(max_call_depth) +
+               ".");
 }
 
 }  // namespace Interpreter
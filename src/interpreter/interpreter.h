@@ -34,6 +34,7 @@ struct Interpreter {
     InitBuiltInFunctionDeclaration(*this);
     global_memory = new Memory();
     global_memory->GetMemory().reserve(1024);
+    AddRoot(global_memory);
   }
   virtual ~Interpreter() = default;
 
@@ -55,6 +56,22 @@ struct Interpreter {
       builtin_functions;
 
   std::size_t current_class_index = 0;
+
+  // The global slots holding int and float literals of the code, which the
+  // optimizer folds.
+  std::unordered_set<std::size_t> literals;
+
+  // The vm types of the values the generated functions return, by full name,
+  // which the optimizer gives the results of their calls. 0x00 if an
+  // overload may return a value of another type.
+  std::unordered_map<std::string, uint8_t> return_types;
+
+  // The generated functions small enough to be inlined, by full name.
+  std::unordered_map<std::string, InlineCandidate> inline_candidates;
+
+  // Whether Run() reports the optimizer, allocator, collector and call
+  // statistics after the program ends. Set by -fstats.
+  bool print_stats = false;
   
   // Track imported aliases in this interpreter to detect name conflicts within the same file
   std::unordered_set<std::string> imported_aliases;
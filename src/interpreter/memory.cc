@@ -4,6 +4,7 @@
 
 #include "interpreter/memory.h"
 
+#include <algorithm>
 #include <functional>
 #include <string>
 
@@ -11,17 +12,31 @@
 
 namespace Aq {
 namespace Interpreter {
+std::size_t Memory::AddSlot(const Object& object) {
+  if (free_slots_.empty()) {
+    memory_.push_back(object);
+    return memory_.size() - 1;
+  }
+
+  std::size_t index = free_slots_.back();
+  free_slots_.pop_back();
+  memory_[index] = object;
+  return index;
+}
+
 std::size_t Memory::Add(std::size_t size) {
+  if (size == 1) return AddSlot({0x00, false, {}});
+
   std::size_t index = memory_.size();
   for (size_t i = 0; i < size; i++) {
-    memory_.push_back({0x00, 0, false});
+    memory_.push_back({0x00, false, {}});
   }
 
   return index;
 }
 
 std::size_t Memory::AddWithType(uint8_t type) {
-  memory_.push_back({type, 0, type != 0x00});
+  memory_.push_back({type, type != 0x00, {}});
 
   return memory_.size() - 1;
 }
@@ -78,38 +93,45 @@ void Memory::SetUint64tValue(std::size_t index, uint64_t value) {
 std::size_t Memory::AddString(std::string value) {
   Object object;
   object.type = 0x05;
-  object.data.string_data = new std::string(value);
+  object.data.string_data = Allocate<String>(std::move(value));
+  object.data.string_data->AddReferenceCount();
   object.constant_type = true;
 
-  memory_.push_back(object);
-  return memory_.size() - 1;
+  return AddSlot(object);
 }
 
 std::size_t Memory::AddReference(Memory* memory, std::size_t index) {
-  ObjectReference* reference = new ObjectReference{false, memory, index};
+  ObjectReference* reference = Allocate<ObjectReference>(
+      ObjectReference{false, memory, index});
 
   Object object;
   object.type = 0x07;
   object.data.reference_data = reference;
   object.constant_type = true;
 
-  memory_.push_back(object);
-  return memory_.size() - 1;
+  return AddSlot(object);
 }
 
 std::size_t Memory::AddReference(ClassMemory* memory, std::string index) {
-  ObjectReference* reference = new ObjectReference();
+  ObjectReference* reference = Allocate<ObjectReference>();
   reference->is_class = true;
   reference->memory.class_memory = memory;
-  reference->index.variable_name = new std::string(index);
+  reference->index.slot = memory->GetMemberSlot(InternSymbol(index));
 
   Object object;
   object.type = 0x07;
   object.data.reference_data = reference;
   object.constant_type = true;
 
-  memory_.push_back(object);
-  return memory_.size() - 1;
+  return AddSlot(object);
+}
+
+void Memory::Release(std::size_t index) {
+  if (index >= memory_.size()) INTERNAL_ERROR("Out of memory.");
+
+  InitGc(&memory_[index]);
+  memory_[index] = {0x00, false, {}};
+  free_slots_.push_back(index);
 }
 
 void Memory::InitObjectData(std::size_t index, ClassMemory* object) {
@@ -139,6 +161,70 @@ void Memory::SetArrayData(std::size_t index, Memory* object) {
   origin_data.data.array_data = object;
 }
 
+std::size_t packed_array_count = 0;
+std::size_t unpacked_array_count = 0;
+
+void Memory::InitPacked(uint8_t type, std::size_t size) {
+  memory_.clear();
+  packed_type_ = type;
+  packed_size_ = packed_constant_size_ = size;
+  packed_.assign((size * GetPackedElementSize() + 7) / 8, 0);
+  packed_array_count++;
+}
+
+void Memory::Unpack() {
+  memory_.resize(packed_size_);
+  for (std::size_t i = 0; i < packed_size_; i++) {
+    Object& object = memory_[i];
+    object.type = packed_type_;
+    object.constant_type = i < packed_constant_size_;
+    switch (packed_type_) {
+      case 0x01:
+        object.data.byte_data = GetPacked<int8_t>(i);
+        break;
+      case 0x02:
+        object.data.int_data = GetPacked<int64_t>(i);
+        break;
+      case 0x03:
+        object.data.float_data = GetPacked<double>(i);
+        break;
+      case 0x04:
+        object.data.uint64t_data = GetPacked<uint64_t>(i);
+        break;
+      default:
+        INTERNAL_ERROR("Unsupported packed type.");
+        break;
+    }
+  }
+
+  packed_type_ = 0x00;
+  packed_.clear();
+  packed_.shrink_to_fit();
+  packed_size_ = packed_constant_size_ = 0;
+  unpacked_array_count++;
+}
+
+std::size_t Memory::PushFrame(const std::vector<Object>& frame) {
+  std::size_t base = memory_.size();
+  memory_.insert(memory_.end(), frame.begin(), frame.end());
+  return base;
+}
+
+void Memory::PopFrame(std::size_t base) {
+  if (base > memory_.size()) INTERNAL_ERROR("Invalid frame base.");
+
+  for (std::size_t i = base; i < memory_.size(); i++) InitGc(&memory_[i]);
+  memory_.resize(base);
+
+  // Released slots of the frame are gone with it.
+  if (!free_slots_.empty())
+    free_slots_.erase(std::remove_if(free_slots_.begin(), free_slots_.end(),
+                                     [base](std::size_t index) {
+                                       return index >= base;
+                                     }),
+                      free_slots_.end());
+}
+
 Object& Memory::GetOriginData(std::size_t index) {
   if (index >= memory_.size()) INTERNAL_ERROR("Out of memory.");
   std::reference_wrapper<Object> object = memory_[index];
@@ -147,7 +233,7 @@ Object& Memory::GetOriginData(std::size_t index) {
     auto reference = object.get().data.reference_data;
     if (reference->is_class) {
       object = std::ref(reference->memory.class_memory
-                            ->GetMembers()[*reference->index.variable_name]);
+                            ->GetSlots()[reference->index.slot]);
     } else {
       object = std::ref(
           reference->memory.memory->GetMemory()[reference->index.index]);
@@ -193,84 +279,93 @@ std::string Memory::GetStringData(std::size_t index) {
     return "";
   }
 
-  return *object.data.string_data;
+  return object.data.string_data->Get();
 }
 
-void ClassMemory::Add(std::string name) { members_[name] = {0x00, 0, false}; }
+void ClassMemory::Add(std::string name) {
+  GetMember(InternSymbol(name)) = {0x00, false, {}};
+}
 
 void ClassMemory::AddWithType(std::string name, uint8_t type) {
-  members_[name] = {type, 0, type != 0x00};
+  GetMember(InternSymbol(name)) = {type, type != 0x00, {}};
 }
 
 void ClassMemory::AddByte(std::string name, int8_t value) {
   Object object;
   object.type = 0x02;
   object.data.int_data = value;
-  members_[name] = object;
+  GetMember(InternSymbol(name)) = object;
 }
 
 void ClassMemory::AddLong(std::string name, int64_t value) {
   Object object;
   object.type = 0x02;
   object.data.int_data = value;
-  members_[name] = object;
+  GetMember(InternSymbol(name)) = object;
 }
 
 void ClassMemory::AddDouble(std::string name, double value) {
   Object object;
   object.type = 0x03;
   object.data.float_data = value;
-  members_[name] = object;
+  GetMember(InternSymbol(name)) = object;
 }
 
 void ClassMemory::AddUint64t(std::string name, uint64_t value) {
   Object object;
   object.type = 0x04;
   object.data.uint64t_data = value;
-  members_[name] = object;
+  GetMember(InternSymbol(name)) = object;
 }
 
 void ClassMemory::AddString(std::string name, std::string value) {
   Object object;
   object.type = 0x05;
-  object.data.string_data = new std::string(value);
-  members_[name] = object;
+  object.data.string_data = Allocate<String>(std::move(value));
+  object.data.string_data->AddReferenceCount();
+  GetMember(InternSymbol(name)) = object;
 }
 
 void ClassMemory::AddReference(std::string name, Memory* memory,
                                std::size_t index) {
-  ObjectReference* reference = new ObjectReference{false, memory, index};
+  ObjectReference* reference = Allocate<ObjectReference>(
+      ObjectReference{false, memory, index});
 
   Object object;
   object.type = 0x07;
   object.data.reference_data = reference;
-  members_[name] = object;
+  GetMember(InternSymbol(name)) = object;
 }
 
 void ClassMemory::AddReference(std::string name, ClassMemory* memory,
                                std::string index) {
-  ObjectReference* reference = new ObjectReference();
+  ObjectReference* reference = Allocate<ObjectReference>();
   reference->is_class = true;
   reference->memory.class_memory = memory;
-  reference->index.variable_name = new std::string(index);
+  reference->index.slot = memory->GetMemberSlot(InternSymbol(index));
 
   Object object;
   object.type = 0x07;
   object.data.reference_data = reference;
   object.constant_type = true;
-  members_[name] = object;
+  GetMember(InternSymbol(name)) = object;
 }
 
 Object& ClassMemory::GetOriginData(std::string index) {
-  if (members_.find(index) == members_.end())
-    LOGGING_ERROR("Class member not found: " + index);
-  std::reference_wrapper<Object> object = members_[index];
+  return GetOriginData(InternSymbol(index));
+}
+
+Object& ClassMemory::GetOriginData(Symbol index) {
+  Object* member = FindMember(index);
+  if (member == nullptr)
+    LOGGING_ERROR("Class member not found: " + GetSymbolName(index));
+  std::reference_wrapper<Object> object = *member;
 
   while (object.get().type == 0x07) {
     auto reference = object.get().data.reference_data;
     if (reference->is_class) {
       object = std::ref(reference->memory.class_memory
-                            ->GetMembers()[*reference->index.variable_name]);
+                            ->GetSlots()[reference->index.slot]);
     } else {
       object = std::ref(
           reference->memory.memory->GetMemory()[reference->index.index]);
@@ -9,15 +9,26 @@
 #include <cstring>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "interpreter/allocator.h"
+#include "interpreter/collector.h"
 #include "interpreter/inline.h"
+#include "interpreter/shape.h"
+#include "interpreter/symbol.h"
 #include "logging/logging.h"
 
 namespace Aq {
 namespace Interpreter {
 class Memory;
 class ClassMemory;
+class String;
+
+// Number of arrays created packed, and of packed arrays that had to be turned
+// into objects.
+extern std::size_t packed_array_count;
+extern std::size_t unpacked_array_count;
 
 // ObjectReference represents a reference to a variable in memory.
 // It can reference either a Memory object (for regular variables/arrays)
@@ -35,16 +46,20 @@ struct ObjectReference {
   
   // Union to store the location within the memory.
   // For Memory: index is a numeric position.
-  // For ClassMemory: variable_name is a string identifier.
+  // For ClassMemory: slot is the slot of the member in the class object.
   union {
     std::size_t index;
-    std::string* variable_name;
+    std::size_t slot;
   } index;
 };
 
 // Object represents a single value in the AQ interpreter's memory system.
 // It uses a tagged union approach where the 'type' field determines which
 // member of the 'data' union is valid.
+//
+// Memory slots, array elements and class members are all objects, so the tag
+// and the flag come first and share the padding in front of the union: an
+// object takes 16 bytes.
 struct Object {
   // Type tag indicating which data union member is active:
   // 0x00: Uninitialized/null
@@ -59,7 +74,11 @@ struct Object {
   // 0x09: class object
   // 0x0A: pointer
   uint8_t type;
-  
+
+  // Indicates whether this object's type can be changed.
+  // Constant objects maintain their type and value throughout their lifetime.
+  bool constant_type = false;
+
   // Tagged union containing the actual value.
   // Only one member is valid at a time, determined by the type field.
   union {
@@ -67,23 +86,69 @@ struct Object {
     int64_t int_data;                 // 0x02 (int)
     double float_data;                // 0x03 (float)
     uint64_t uint64t_data;            // 0x04 (uint64t)
-    std::string* string_data;         // 0x05 (string)
+    String* string_data;              // 0x05 (string)
     Memory* array_data;               // 0x06 (array)
     ObjectReference* reference_data;  // 0x07 (reference)
     // [[deprecated]] 0x08 (const)
     ClassMemory* class_data;          // 0x09 (class)
     void* pointer_data;               // 0x0A (pointer)
   } data;
-  
-  // Indicates whether this object's type can be changed.
-  // Constant objects maintain their type and value throughout their lifetime.
-  bool constant_type = false;
+};
+static_assert(sizeof(Object) == 16, "Objects take 16 bytes.");
+
+// String holds the text of a string object (0x05). The text of a shared
+// string never changes, so assigning a string or passing it as an argument
+// shares the String and adds a reference instead of copying the text, and
+// changing a string creates a new one. Only a string that a single object
+// holds is appended to in place. Short text is kept in the inline buffer of
+// std::string, so such a string takes one allocation.
+class String {
+ public:
+  explicit String(const std::string& value) : value_(value) {}
+  explicit String(std::string&& value) : value_(std::move(value)) {}
+  ~String() = default;
+
+  String(const String&) = delete;
+  String& operator=(const String&) = delete;
+
+  // Gets the text of the string.
+  const std::string& Get() const { return value_; }
+
+  // Returns whether more than one object holds the string.
+  bool IsShared() const { return reference_count_ > 1; }
+
+  // Appends |value| to the text. Only for strings that aren't shared.
+  void Append(const std::string& value) { value_.append(value); }
+
+  // Increments the reference count for this String object.
+  void AddReferenceCount() { reference_count_++; }
+
+  // Decrements the reference count and deletes this object if it reaches zero.
+  void RemoveReferenceCount() {
+    if (reference_count_ > 0) reference_count_--;
+    if (reference_count_ <= 0) Deallocate(this);
+  }
+
+ private:
+  // The text of the string.
+  std::string value_;
+
+  // Reference counter for automatic memory management.
+  int64_t reference_count_ = 0;
 };
 
+// Adds a reference to the strings of |objects|. Called after copying objects
+// from other objects, since the copies share the strings.
+FORCE_INLINE void ShareStrings(std::vector<Object>& objects) {
+  for (Object& object : objects)
+    if (object.type == 0x05 && object.data.string_data != nullptr)
+      object.data.string_data->AddReferenceCount();
+}
+
 // Memory manages a contiguous vector of Object instances, providing allocation
 // and access methods for the AQ interpreter's runtime memory system.
 // This class implements reference counting for automatic memory management.
-class Memory {
+class Memory : public Collectable {
  public:
   Memory() = default;
   virtual ~Memory() = default;
@@ -129,6 +194,12 @@ class Memory {
   // Returns the index where the reference is stored.
   std::size_t AddReference(ClassMemory* memory, std::string index);
 
+  // Frees the data of the object at |index| and lets Add(1), AddString() and
+  // AddReference() reuse its slot, so calls that need a few slots each time,
+  // like calls into modules, don't grow the memory. Only release slots that
+  // nothing refers to anymore.
+  void Release(std::size_t index);
+
   // Initializes an object at the given index with class data.
   void InitObjectData(std::size_t index, ClassMemory* object);
   
@@ -138,6 +209,14 @@ class Memory {
   // Updates an existing object with array data.
   void SetArrayData(std::size_t index, Memory* object);
 
+  // Pushes an activation frame initialized from |frame| onto the top of the
+  // memory. Returns the index of the first slot of the frame.
+  std::size_t PushFrame(const std::vector<Object>& frame);
+
+  // Pops the activation frame starting at |base| together with everything
+  // allocated above it, and frees the data owned by its slots.
+  void PopFrame(std::size_t base);
+
   // Returns a direct reference to the Object at the given index.
   // The returned reference allows modification of the object.
   Object& GetOriginData(std::size_t index);
@@ -150,11 +229,62 @@ class Memory {
 
   // Returns a reference to the internal memory vector.
   // This allows direct access to all objects for iteration or bulk operations.
-  std::vector<Object>& GetMemory() { return memory_; }
+  // A packed array is unpacked first.
+  std::vector<Object>& GetMemory() {
+    if (packed_type_ != 0x00) Unpack();
+    return memory_;
+  }
   
   // Replaces the entire memory vector with a new one.
   // Uses move semantics for efficiency.
-  void SetMemory(std::vector<Object>& memory) { memory_ = std::move(memory); }
+  void SetMemory(std::vector<Object>& memory) {
+    packed_type_ = 0x00;
+    packed_.clear();
+    free_slots_.clear();
+    memory_ = std::move(memory);
+  }
+
+  // Makes the memory a packed array of |size| zero elements of |type|: byte
+  // (0x01), int (0x02), float (0x03) or uint64 (0x04). A packed array stores
+  // the raw values without their tags, one byte for bytes and 8 bytes for the
+  // other types, until something needs its elements as objects.
+  void InitPacked(uint8_t type, std::size_t size);
+
+  // Gets the element type of a packed array, or 0x00 if the elements are
+  // objects.
+  uint8_t GetPackedType() const { return packed_type_; }
+
+  // Gets the number of elements of a packed array.
+  std::size_t GetPackedSize() const { return packed_size_; }
+
+  // Gets the number of elements of a packed array that have the constant
+  // element type. The elements appended after them don't.
+  std::size_t GetPackedConstantSize() const { return packed_constant_size_; }
+
+  // Gets the raw elements of a packed array.
+  void* GetPackedData() { return packed_.data(); }
+
+  // Gets and sets element |index| of a packed array of |T|.
+  template <typename T>
+  T GetPacked(std::size_t index) const {
+    T value;
+    std::memcpy(&value, reinterpret_cast<const char*>(packed_.data()) +
+                            index * sizeof(T),
+                sizeof(T));
+    return value;
+  }
+  template <typename T>
+  void SetPacked(std::size_t index, T value) {
+    std::memcpy(reinterpret_cast<char*>(packed_.data()) + index * sizeof(T),
+                &value, sizeof(T));
+  }
+
+  // Appends a zero element to a packed array.
+  void AppendPacked() {
+    packed_size_++;
+    std::size_t words = (packed_size_ * GetPackedElementSize() + 7) / 8;
+    if (words > packed_.size()) packed_.resize(words);
+  }
 
   // Increments the reference count for this Memory object.
   // Used for reference-counted memory management to track how many
@@ -166,13 +296,46 @@ class Memory {
   // the Memory object is automatically freed.
   void RemoveReferenceCount() {
     if (reference_count_ > 0) reference_count_--;
-    if (reference_count_ <= 0) delete this;
+    if (reference_count_ <= 0) Deallocate(this);
+  }
+
+  // The elements of a packed array hold no other objects, so they aren't
+  // unpacked for the collector.
+  std::vector<Object>& GetTracedObjects() override { return memory_; }
+
+  std::size_t Free() override {
+    std::size_t size = sizeof(Memory) + memory_.capacity() * sizeof(Object) +
+                       packed_.capacity() * sizeof(uint64_t);
+    Deallocate(this);
+    return size;
   }
 
  private:
+  // Gets the bytes of an element of a packed array.
+  std::size_t GetPackedElementSize() const {
+    return packed_type_ == 0x01 ? 1 : 8;
+  }
+
+  // Turns a packed array into objects. The array stays unpacked afterwards.
+  void Unpack();
+
   // Vector storing all objects in this memory region.
-  // Objects are accessed by their index in this vector.
+  // Objects are accessed by their index in this vector. Empty while the
+  // memory is a packed array.
   std::vector<Object> memory_;
+
+  // Released slots below the top of the memory, reused by the next adds.
+  std::vector<std::size_t> free_slots_;
+
+  // Stores |object| in a released slot, or in a new one if there is none.
+  // Returns the index of the slot.
+  std::size_t AddSlot(const Object& object);
+
+  // The element type, the elements and the element counts of a packed array.
+  uint8_t packed_type_ = 0x00;
+  std::vector<uint64_t> packed_;
+  std::size_t packed_size_ = 0;
+  std::size_t packed_constant_size_ = 0;
   
   // Reference counter for automatic memory management.
   // When this reaches zero, the Memory object can be safely deleted.
@@ -182,7 +345,7 @@ class Memory {
 // ClassMemory manages named members of a class instance.
 // Unlike Memory which uses numeric indices, ClassMemory uses string names
 // to identify members (fields and methods) of a class object.
-class ClassMemory {
+class ClassMemory : public Collectable {
  public:
   ClassMemory() = default;
   virtual ~ClassMemory() = default;
@@ -218,9 +381,44 @@ class ClassMemory {
   // Allows direct access and modification of the member.
   Object& GetOriginData(std::string index);
 
-  // Returns the internal map of all members.
+  // Returns a reference to the Object stored under the given symbol.
+  Object& GetOriginData(Symbol index);
+
+  // Returns a reference to the member with the given symbol, adding an
+  // uninitialized member if the class instance has none.
+  Object& GetMember(Symbol name) { return slots_[GetMemberSlot(name)]; }
+
+  // Returns a pointer to the member with the given symbol, or nullptr if the
+  // class instance has none.
+  Object* FindMember(Symbol name) {
+    std::size_t slot = shape_->FindSlot(name);
+    return slot == Shape::kNoSlot ? nullptr : &slots_[slot];
+  }
+
+  // Returns the slot of the member with the given symbol, adding an
+  // uninitialized member if the class instance has none. Slots of existing
+  // members never change, so references can hold them.
+  std::size_t GetMemberSlot(Symbol name) {
+    std::size_t slot = shape_->FindSlot(name);
+    if (slot != Shape::kNoSlot) return slot;
+    shape_ = shape_->AddMember(name);
+    slots_.push_back({0x00, false, {}});
+    return slots_.size() - 1;
+  }
+
+  // Replaces the members with copies of the members of |other|.
+  void CopyMembers(ClassMemory* other) {
+    shape_ = other->shape_;
+    slots_ = other->slots_;
+    ShareStrings(slots_);
+  }
+
+  // Returns the shape that names the slots of the class instance.
+  Shape* GetShape() { return shape_; }
+
+  // Returns the members in slot order.
   // This allows iteration over all members of the class instance.
-  std::unordered_map<std::string, Object>& GetMembers() { return members_; }
+  std::vector<Object>& GetSlots() { return slots_; }
 
   // Increments the reference count for this ClassMemory object.
   void AddReferenceCount() { reference_count_++; }
@@ -229,13 +427,23 @@ class ClassMemory {
   // Implements automatic memory management for class instances.
   void RemoveReferenceCount() {
     if (reference_count_ > 0) reference_count_--;
-    if (reference_count_ <= 0) delete this;
+    if (reference_count_ <= 0) Deallocate(this);
+  }
+
+  std::vector<Object>& GetTracedObjects() override { return slots_; }
+
+  std::size_t Free() override {
+    std::size_t size = sizeof(ClassMemory) + slots_.capacity() * sizeof(Object);
+    Deallocate(this);
+    return size;
   }
 
  private:
-  // Map of member names to their Object values.
-  // Allows O(1) lookup of members by name.
-  std::unordered_map<std::string, Object> members_;
+  // The layout of the members and their values in slot order. Class
+  // instances copy both from their class, so creating one copies a flat
+  // vector and members are found without hashing their names.
+  Shape* shape_ = Shape::GetEmptyShape();
+  std::vector<Object> slots_;
   
   // Reference counter for automatic memory management.
   int64_t reference_count_ = 0;
@@ -246,16 +454,15 @@ class ClassMemory {
 // an Object to prevent memory leaks.
 FORCE_INLINE void RunGc(Object* object) {
   switch (object->type) {
-    case 0x05:  // String: delete the heap-allocated string
-      delete object->data.string_data;
+    case 0x05:  // String: decrement the reference count of the string
+      if (object->data.string_data != nullptr)
+        object->data.string_data->RemoveReferenceCount();
       break;
     case 0x06:  // Array: decrement the reference count of the array Memory
       object->data.array_data->RemoveReferenceCount();
       break;
-    case 0x07:  // Reference: delete the variable name (if class) and the reference struct
-      if (object->data.reference_data->is_class)
-        delete object->data.reference_data->index.variable_name;
-      delete object->data.reference_data;
+    case 0x07:  // Reference: drop the reference struct
+      Deallocate(object->data.reference_data);
       break;
     case 0x09:  // Class: decrement the reference count of the class instance
       object->data.class_data->RemoveReferenceCount();
@@ -275,9 +482,9 @@ FORCE_INLINE Object* GetOrigin(Object* object) {
   while (object->type == 0x07) {
     auto reference = object->data.reference_data;
     if (reference->is_class) {
-      // Reference to a class member: look up by name
+      // Reference to a class member: look up by slot
       object = &reference->memory.class_memory
-                    ->GetMembers()[*reference->index.variable_name];
+                    ->GetSlots()[reference->index.slot];
     } else {
       // Reference to a Memory location: look up by index
       object = &reference->memory.memory->GetMemory()[reference->index.index];
@@ -483,29 +690,55 @@ FORCE_INLINE void SetUint64(Object* object, uint64_t data) {
   object->data.uint64t_data = data;
 }
 
-FORCE_INLINE std::string GetString(Object* object) {
+// Gets the text of a string object. The text stays valid while the string
+// object holds it.
+FORCE_INLINE const std::string& GetString(Object* object) {
+  static const std::string empty_string;
   if (object->type == 0x07) object = GetOrigin(object);
   switch (object->type) {
     case 0x05:
-      return *object->data.string_data;
+      return object->data.string_data->Get();
     default:
       LOGGING_ERROR("Unsupported data type: " + std::to_string(object->type));
       break;
   }
 
-  return "";
+  return empty_string;
 }
 
-FORCE_INLINE void SetString(Object* object, const std::string& data) {
+// Makes |object| share the string |data|.
+FORCE_INLINE void SetStringData(Object* object, String* data) {
   if (object->type == 0x07) object = GetOrigin(object);
   if (object->constant_type && object->type != 0x05) {
     LOGGING_ERROR("Unsupported data type: " + std::to_string(object->type));
     return;
   }
 
+  // The new string gets its reference first, since |object| may already hold
+  // it.
+  data->AddReferenceCount();
   RunGc(object);
   object->type = 0x05;
-  object->data.string_data = new std::string(data);
+  object->data.string_data = data;
+}
+
+FORCE_INLINE void SetString(Object* object, const std::string& data) {
+  SetStringData(object, Allocate<String>(data));
+}
+
+FORCE_INLINE void SetString(Object* object, std::string&& data) {
+  SetStringData(object, Allocate<String>(std::move(data)));
+}
+
+// Sets |object| to the string of |value|. A string object shares its string
+// instead of copying the text.
+FORCE_INLINE void CopyString(Object* object, Object* value) {
+  if (value->type == 0x07) value = GetOrigin(value);
+  if (value->type == 0x05 && value->data.string_data != nullptr) {
+    SetStringData(object, value->data.string_data);
+    return;
+  }
+  SetString(object, GetString(value));
 }
 
 FORCE_INLINE Memory* GetArray(Object* object) {
@@ -529,7 +762,7 @@ FORCE_INLINE void SetArrayContent(Object* object, std::vector<Object>& data) {
 
   RunGc(object);
   object->type = 0x06;
-  object->data.array_data = new Memory();
+  object->data.array_data = Allocate<Memory>();
   object->data.array_data->SetMemory(data);
 }
 
@@ -577,7 +810,7 @@ FORCE_INLINE void SetReference(Object* object, ObjectReference reference) {
   RunGc(object);
   if (object->type == 0x07 || !object->constant_type) {
     object->type = 0x07;
-    object->data.reference_data = new ObjectReference(reference);
+    object->data.reference_data = Allocate<ObjectReference>(reference);
   } else {
     LOGGING_ERROR("Cannot set reference to constant type memory.");
   }
@@ -586,18 +819,16 @@ FORCE_INLINE void SetReference(Object* object, ObjectReference reference) {
 FORCE_INLINE void InitGc(Object* object) {
   switch (object->type) {
     case 0x05:
-      if (object->data.string_data != nullptr) delete object->data.string_data;
+      if (object->data.string_data != nullptr)
+        object->data.string_data->RemoveReferenceCount();
       break;
     case 0x06:
       if (object->data.array_data != nullptr)
         object->data.array_data->RemoveReferenceCount();
       break;
     case 0x07:
-      if (object->data.reference_data != nullptr) {
-        if (object->data.reference_data->is_class)
-          delete object->data.reference_data->index.variable_name;
-        delete object->data.reference_data;
-      }
+      if (object->data.reference_data != nullptr)
+        Deallocate(object->data.reference_data);
       break;
     case 0x09:
       if (object->data.class_data != nullptr)
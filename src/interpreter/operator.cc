@@ -40,7 +40,8 @@ int NEW(Object* memory, std::unordered_map<std::string, Class>& classes,
             builtin_functions) {
   Object type_data = memory[type];
 
-  std::size_t size_value = GetUint64(memory + size);
+  std::size_t size_value =
+      IsImmediateOperand(size) ? GetImmediate(size) : GetUint64(memory + size);
 
   // If no size specified and not a class, default to allocating one element
   if ((type == 0 ||
@@ -49,8 +50,8 @@ int NEW(Object* memory, std::unordered_map<std::string, Class>& classes,
     size_value = 1;
 
   // Prepare memory structures for the new object
-  Memory* array_memory = new Memory();
-  ClassMemory* class_memory = new ClassMemory();
+  Memory* array_memory = Allocate<Memory>();
+  ClassMemory* class_memory = Allocate<ClassMemory>();
 
   auto& data = array_memory->GetMemory();
 
@@ -71,13 +72,16 @@ int NEW(Object* memory, std::unordered_map<std::string, Class>& classes,
           LOGGING_ERROR("class not found.");
         Class& class_data = classes[class_name];
         
-        class_memory->GetMembers() = class_data.GetMembers()->GetMembers();
+        class_memory->CopyMembers(class_data.GetMembers());
         
         // Clear constant_type for all members (except special members) to allow mutation
-        for (auto& member_pair : class_memory->GetMembers()) {
+        auto& slots = class_memory->GetSlots();
+        for (std::size_t i = 0; i < slots.size(); i++) {
           // Skip special members like @name
-          if (member_pair.first.length() > 0 && member_pair.first[0] != '@') {
-            member_pair.second.constant_type = false;
+          const std::string& member_name =
+              GetSymbolName(class_memory->GetShape()->GetName(i));
+          if (member_name.length() > 0 && member_name[0] != '@') {
+            slots[i].constant_type = false;
           }
         }
         
@@ -94,8 +98,10 @@ int NEW(Object* memory, std::unordered_map<std::string, Class>& classes,
           LOGGING_ERROR("class not found.");
         Class& class_data = classes[class_name];
 
-        auto class_memory = new ClassMemory();
-        *class_memory = *class_data.GetMembers();
+        // The array holds the element.
+        auto class_memory = Allocate<ClassMemory>();
+        class_memory->CopyMembers(class_data.GetMembers());
+        class_memory->AddReferenceCount();
 
         Object object;
         object.type = 0x09;
@@ -104,6 +110,10 @@ int NEW(Object* memory, std::unordered_map<std::string, Class>& classes,
         data.push_back(object);
       }
 
+    } else if (type_data.type >= 0x01 && type_data.type <= 0x04) {
+      // Numeric array type. The elements stay packed until something needs
+      // them as objects.
+      array_memory->InitPacked(type_data.type, size_value);
     } else {
       // Array type.
       for (size_t i = 0; i < size_value; i++) {
@@ -118,8 +128,11 @@ int NEW(Object* memory, std::unordered_map<std::string, Class>& classes,
   if (size_value == 0 && type_data.type == 0x05 &&
       type_data.data.string_data != nullptr) {
     InitObject(GetOrigin(memory + ptr), class_memory);
+    // The array only held the class object while it was built.
+    Deallocate(array_memory);
   } else {
     InitArray(GetOrigin(memory + ptr), array_memory);
+    Deallocate(class_memory);
   }
 
   return 0;
@@ -134,8 +147,8 @@ int ARRAY(
   auto array_object = memory[ptr];
   auto array = array_object.data.array_data;
 
-  auto index_object = memory[index];
-  index = GetUint64(memory + index);
+  index = IsImmediateOperand(index) ? GetImmediate(index)
+                                    : GetUint64(memory + index);
 
   if (index >= array->GetMemory().size()) array->GetMemory().resize(index + 1);
 
@@ -144,6 +157,121 @@ int ARRAY(
   return 0;
 }
 
+// Gets the index an array access operand names.
+FORCE_INLINE std::size_t GetElementIndex(Object* memory, std::size_t index) {
+  return IsImmediateOperand(index) ? GetImmediate(index)
+                                   : GetUint64(memory + index);
+}
+
+// Gets the array in |object| if it is a packed array, or nullptr.
+FORCE_INLINE Memory* GetPackedArray(Object* object) {
+  if (object->type != 0x06 || object->data.array_data == nullptr ||
+      object->data.array_data->GetPackedType() == 0x00)
+    return nullptr;
+  return object->data.array_data;
+}
+
+// Copies element |index| of the packed |array| into |result|. Returns false
+// if the element doesn't exist or |result| can't take its type.
+FORCE_INLINE bool LoadPackedElement(Object* result, Memory* array,
+                                    std::size_t index) {
+  uint8_t type = array->GetPackedType();
+  if (index >= array->GetPackedSize()) return false;
+  if (result->constant_type && result->type != type) return false;
+
+  // Drops the reference an earlier run on an unpacked array left.
+  RunGc(result);
+  result->type = type;
+  switch (type) {
+    case 0x01:
+      result->data.byte_data = array->GetPacked<int8_t>(index);
+      break;
+    case 0x02:
+      result->data.int_data = array->GetPacked<int64_t>(index);
+      break;
+    case 0x03:
+      result->data.float_data = array->GetPacked<double>(index);
+      break;
+    default:
+      result->data.uint64t_data = array->GetPacked<uint64_t>(index);
+      break;
+  }
+  return true;
+}
+
+// Stores |value| into element |index| of the packed |array|, appending it if
+// |index| is the size of the array. Returns false if the element can't hold
+// the value without changing the layout of the array. Elements created by NEW
+// have a constant type and take the values their Set function converts
+// without a warning. Appended elements take values of the element type, and
+// int elements also take bytes.
+FORCE_INLINE bool StorePackedElement(Memory* array, std::size_t index,
+                                     Object* value) {
+  if (index > array->GetPackedSize()) return false;
+  bool is_constant = index < array->GetPackedConstantSize();
+  switch (array->GetPackedType()) {
+    case 0x01:
+      if (value->type != 0x01) return false;
+      if (index == array->GetPackedSize()) array->AppendPacked();
+      array->SetPacked<int8_t>(index, value->data.byte_data);
+      return true;
+    case 0x02:
+      if (value->type != 0x01 && value->type != 0x02) return false;
+      if (index == array->GetPackedSize()) array->AppendPacked();
+      array->SetPacked<int64_t>(index, value->type == 0x01
+                                           ? value->data.byte_data
+                                           : value->data.int_data);
+      return true;
+    case 0x03:
+      if (value->type != 0x03 &&
+          !(is_constant && (value->type == 0x01 || value->type == 0x02)))
+        return false;
+      if (index == array->GetPackedSize()) array->AppendPacked();
+      array->SetPacked<double>(
+          index, value->type == 0x03   ? value->data.float_data
+                 : value->type == 0x02 ? value->data.int_data
+                                       : value->data.byte_data);
+      return true;
+    case 0x04:
+      if (value->type != 0x04) return false;
+      if (index == array->GetPackedSize()) array->AppendPacked();
+      array->SetPacked<uint64_t>(index, value->data.uint64t_data);
+      return true;
+    default:
+      return false;
+  }
+}
+
+int LOAD_ELEMENT(
+    Object* memory, std::size_t result, std::size_t ptr, std::size_t index,
+    std::unordered_map<std::string, Class>& classes,
+    std::unordered_map<std::string,
+                       std::function<int(Memory*, std::vector<std::size_t>)>>&
+        builtin_functions) {
+  Memory* array = GetPackedArray(memory + ptr);
+  if (array != nullptr &&
+      LoadPackedElement(memory + result, array, GetElementIndex(memory, index)))
+    return 0;
+  return ARRAY(memory, result, ptr, index, classes, builtin_functions);
+}
+
+int STORE_ELEMENT(
+    Object* memory, std::size_t result, std::size_t ptr, std::size_t index,
+    std::size_t value, std::unordered_map<std::string, Class>& classes,
+    std::unordered_map<std::string,
+                       std::function<int(Memory*, std::vector<std::size_t>)>>&
+        builtin_functions) {
+  Memory* array = GetPackedArray(memory + ptr);
+  if (array != nullptr &&
+      StorePackedElement(array, GetElementIndex(memory, index),
+                         GetOrigin(memory + value)))
+    return 0;
+
+  // The array is unpacked by ARRAY if the store didn't fit.
+  ARRAY(memory, result, ptr, index, classes, builtin_functions);
+  return EQUAL(memory, result, value);
+}
+
 int ADD(Object* memory, std::size_t result, std::size_t operand1,
         std::size_t operand2) {
   Object* operand1_object = GetOrigin(memory + operand1);
@@ -170,10 +298,21 @@ int ADD(Object* memory, std::size_t result, std::size_t operand1,
       SetUint64(memory + result,
                 GetUint64(operand1_object) + GetUint64(operand2_object));
       break;
-    case 0x05:
+    case 0x05: {
+      // s = s + x appends to s in place when no other object holds its
+      // string, so that building a string in a loop doesn't copy it every
+      // time.
+      Object* result_object = GetOrigin(memory + result);
+      if (result_object == operand1_object && operand1_object->type == 0x05 &&
+          operand1_object->data.string_data != nullptr &&
+          !operand1_object->data.string_data->IsShared()) {
+        operand1_object->data.string_data->Append(GetString(operand2_object));
+        break;
+      }
       SetString(memory + result,
                 GetString(operand1_object) + GetString(operand2_object));
       break;
+    }
     case 0x06: {
       auto& array1 = GetArray(operand1_object)->GetMemory();
       auto& array2 = GetArray(operand2_object)->GetMemory();
@@ -181,6 +320,7 @@ int ADD(Object* memory, std::size_t result, std::size_t operand1,
       new_array.reserve(array1.size() + array2.size());
       new_array.insert(new_array.end(), array1.begin(), array1.end());
       new_array.insert(new_array.end(), array2.begin(), array2.end());
+      ShareStrings(new_array);
       SetArrayContent(memory + result, new_array);
       break;
     }
@@ -929,8 +1069,8 @@ int EQUAL(Object* memory, std::size_t result, std::size_t value) {
     case 0x04:  // Uint64: copy uint64_t value
       SetUint64(memory + result, GetUint64(value_object));
       break;
-    case 0x05:  // String: copy string value
-      SetString(memory + result, GetString(value_object));
+    case 0x05:  // String: share the string
+      CopyString(memory + result, value_object);
       break;
     case 0x06:
       SetArrayContent(memory + result, GetArray(value_object)->GetMemory());
@@ -950,9 +1090,7 @@ int EQUAL(Object* memory, std::size_t result, std::size_t value) {
   return 0;
 }
 
-std::size_t GOTO(Object* memory, std::size_t location) {
-  return GetUint64(memory + location);
-}
+std::size_t GOTO(std::size_t location) { return location; }
 
 int INVOKE_METHOD(
     Memory* memory, std::unordered_map<std::string, Class>& classes,
@@ -979,24 +1117,222 @@ int INVOKE_METHOD(
                            classes, builtin_functions);
 }
 
-int InvokeClassMethod(
-    Memory* memory, std::size_t class_object, std::size_t method_name_object,
-    std::vector<size_t> arguments,
-    std::unordered_map<std::string, Class>& classes,
-    std::unordered_map<std::string,
-                       std::function<int(Memory*, std::vector<std::size_t>)>>&
-        builtin_functions) {
-  auto memory_ptr = memory->GetMemory().data();
+// Number of instructions rewritten into a quickened form.
+std::size_t quickened_instruction_count = 0;
+
+// Number of quickened instructions that failed their type guard.
+std::size_t deoptimized_instruction_count = 0;
+
+// Returns true if the |result| and both operands of a quickened arithmetic
+// instruction hold |type| directly.
+FORCE_INLINE bool HasOperandTypes(Object* memory, std::size_t result,
+                                  std::size_t operand1, std::size_t operand2,
+                                  uint8_t type) {
+  return memory[result].type == type && memory[operand1].type == type &&
+         memory[operand2].type == type;
+}
+
+// Returns true if both operands of a quickened CMP instruction hold |type|
+// directly and its |result| already holds a byte.
+FORCE_INLINE bool HasCompareTypes(Object* memory, std::size_t result,
+                                  std::size_t operand1, std::size_t operand2,
+                                  uint8_t type) {
+  return memory[result].type == 0x01 && memory[operand1].type == type &&
+         memory[operand2].type == type;
+}
+
+template <typename T>
+FORCE_INLINE int8_t CompareValues(std::size_t opcode, T operand1, T operand2) {
+  switch (opcode) {
+    case 0x00:
+      return operand1 == operand2;
+    case 0x01:
+      return operand1 != operand2;
+    case 0x02:
+      return operand1 > operand2;
+    case 0x03:
+      return operand1 >= operand2;
+    case 0x04:
+      return operand1 < operand2;
+    case 0x05:
+      return operand1 <= operand2;
+    default:
+      LOGGING_ERROR("Unsupported comparison opcode: " +
+                    std::to_string(opcode));
+      return 0;
+  }
+}
+
+// Rewrites a generic arithmetic |instruction| that has just run into its
+// quickened int or float form if all of its slots hold that type. The slots
+// are passed already resolved against the current frame. Pass NOP as
+// |float_oper| if the operator has no float form. Instructions that failed a
+// guard before stay generic.
+FORCE_INLINE void QuickenArithmetic(Object* memory, Bytecode& instruction,
+                                    std::size_t result, std::size_t operand1,
+                                    std::size_t operand2, uint8_t int_oper,
+                                    uint8_t float_oper) {
+  if (instruction.is_deoptimized) return;
+  if (HasOperandTypes(memory, result, operand1, operand2, 0x02)) {
+    instruction.oper = int_oper;
+    quickened_instruction_count++;
+  } else if (float_oper != _AQVM_OPERATOR_NOP &&
+             HasOperandTypes(memory, result, operand1, operand2, 0x03)) {
+    instruction.oper = float_oper;
+    quickened_instruction_count++;
+  }
+}
+
+// Rewrites a generic CMP |instruction| that has just run into its quickened
+// int or float form if both operands hold that type.
+FORCE_INLINE void QuickenCompare(Object* memory, Bytecode& instruction,
+                                 std::size_t result, std::size_t operand1,
+                                 std::size_t operand2) {
+  if (instruction.is_deoptimized || instruction.operand2 > 0x05) return;
+  if (HasCompareTypes(memory, result, operand1, operand2, 0x02)) {
+    instruction.oper = _AQVM_OPERATOR_QUICK_CMPI;
+    quickened_instruction_count++;
+  } else if (HasCompareTypes(memory, result, operand1, operand2, 0x03)) {
+    instruction.oper = _AQVM_OPERATOR_QUICK_CMPF;
+    quickened_instruction_count++;
+  }
+}
+
+// Returns the variadic |arguments| of an instruction with every frame operand
+// resolved against |frame_base|.
+std::vector<std::size_t> ResolveArguments(
+    const std::vector<std::size_t>& arguments, std::size_t frame_base) {
+  std::vector<std::size_t> resolved(arguments.size());
+  for (std::size_t i = 0; i < arguments.size(); i++)
+    resolved[i] = ResolveOperand(arguments[i], frame_base);
+  return resolved;
+}
+
+// Puts a quickened |instruction| whose type guard failed back on its generic
+// operator for good.
+FORCE_INLINE void Deoptimize(Bytecode& instruction, uint8_t generic_oper) {
+  instruction.oper = generic_oper;
+  instruction.is_deoptimized = true;
+  deoptimized_instruction_count++;
+}
+
+// Number of instruction pairs fused into superinstructions.
+std::size_t fused_instruction_count = 0;
+
+// Number of ARRAY instructions rewritten into element loads and stores.
+std::size_t specialized_element_access_count = 0;
+
+// Runs the CMP at |compare| and the IF that follows it. Returns the position
+// the IF branches to. The typed pairs skip the type checks.
+FORCE_INLINE std::size_t CompareAndBranch(Object* memory,
+                                          const Bytecode* compare,
+                                          std::size_t frame_base) {
+  const std::size_t result = ResolveOperand(compare->operand1, frame_base);
+  const std::size_t operand1 = ResolveOperand(compare->operand3, frame_base);
+  const std::size_t operand2 = ResolveOperand(compare->operand4, frame_base);
+  if (compare->oper == _AQVM_OPERATOR_CMPI_IF) {
+    memory[result].data.byte_data =
+        CompareValues(compare->operand2, memory[operand1].data.int_data,
+                      memory[operand2].data.int_data);
+  } else if (compare->oper == _AQVM_OPERATOR_CMPF_IF) {
+    memory[result].data.byte_data =
+        CompareValues(compare->operand2, memory[operand1].data.float_data,
+                      memory[operand2].data.float_data);
+  } else if (compare->operand2 <= 0x05 &&
+             HasCompareTypes(memory, result, operand1, operand2, 0x02)) {
+    memory[result].data.byte_data =
+        CompareValues(compare->operand2, memory[operand1].data.int_data,
+                      memory[operand2].data.int_data);
+  } else if (compare->operand2 <= 0x05 &&
+             HasCompareTypes(memory, result, operand1, operand2, 0x03)) {
+    memory[result].data.byte_data =
+        CompareValues(compare->operand2, memory[operand1].data.float_data,
+                      memory[operand2].data.float_data);
+  } else {
+    CMP(memory, result, compare->operand2, operand1, operand2);
+  }
+
+  const Bytecode* branch = compare + 1;
+  return IF(memory, ResolveOperand(branch->operand1, frame_base),
+            ResolveOperand(branch->operand2, frame_base),
+            ResolveOperand(branch->operand3, frame_base));
+}
+
+// Runs a fused arithmetic instruction on |result|, |operand1| and |operand2|
+// and stores the result into |target| like the EQUAL it was fused with.
+// |generic| is the operator used if the slots do not hold ints or floats.
+template <typename Operation>
+FORCE_INLINE void StoreArithmetic(Object* memory, std::size_t result,
+                                  std::size_t operand1, std::size_t operand2,
+                                  std::size_t target, Operation operation,
+                                  int (*generic)(Object*, std::size_t,
+                                                 std::size_t, std::size_t)) {
+  if (HasOperandTypes(memory, result, operand1, operand2, 0x02) &&
+      memory[target].type == 0x02) {
+    memory[target].data.int_data = memory[result].data.int_data = operation(
+        memory[operand1].data.int_data, memory[operand2].data.int_data);
+    return;
+  }
+  if (HasOperandTypes(memory, result, operand1, operand2, 0x03) &&
+      memory[target].type == 0x03) {
+    memory[target].data.float_data = memory[result].data.float_data =
+        operation(memory[operand1].data.float_data,
+                  memory[operand2].data.float_data);
+    return;
+  }
+  generic(memory, result, operand1, operand2);
+  EQUAL(memory, target, result);
+}
+
+// Number of methods entered since startup.
+std::size_t invoked_method_count = 0;
 
-  auto class_members = GetObject(memory_ptr + class_object)->GetMembers();
-  std::string class_name = *class_members["@name"].data.string_data;
+// Current and deepest nesting of method invocations.
+std::size_t call_depth = 0;
+std::size_t max_call_depth = 0;
+
+// Number of running dispatch loops. Only the outermost loop collects garbage:
+// nested loops run inside an instruction of an outer loop, which may hold
+// objects that aren't reachable from the roots yet.
+std::size_t dispatch_depth = 0;
+
+// Collects garbage if enough collectable objects were created since the last
+// collection. Called at the safe points of the dispatch loop, backward jumps
+// and calls, where every object in use is in memory.
+FORCE_INLINE void CollectAtSafePoint() {
+  if (Collectable::IsCollectionRequested() && dispatch_depth == 1)
+    CollectGarbage();
+}
+
+// The state of a calling method that is saved while its callee runs in the
+// same dispatch loop.
+struct CallFrame {
+  Function* method;
+  int64_t return_index;
+  std::size_t frame_base;
+  std::size_t saved_current_class_index;
+};
+
+// Number of INVOKE_METHOD lookups answered by an inline cache and by name.
+std::size_t inline_cache_hit_count = 0;
+std::size_t inline_cache_miss_count = 0;
+
+// Gets the overloads of the method named by |method_name_object| of
+// |class_object| by name. Returns nullptr if there are none.
+std::vector<Function>* FindClassMethods(
+    Object* memory_ptr, std::size_t class_object,
+    std::size_t method_name_object,
+    std::unordered_map<std::string, Class>& classes) {
+  std::string class_name = GetObject(memory_ptr + class_object)
+                               ->GetMember(kClassNameSymbol)
+                               .data.string_data->Get();
   std::string method_name = GetString(memory_ptr + method_name_object);
 
   // Normal method invocation (no cross-interpreter logic here - that's handled by INVOKE_MODULE_METHOD)
   auto class_it = classes.find(class_name);
   if (class_it == classes.end()) {
     LOGGING_ERROR("Class not found: " + class_name);
-    return -1;
+    return nullptr;
   }
 
   auto method_it = class_it->second.GetMethods().find(method_name);
@@ -1005,14 +1341,147 @@ int InvokeClassMethod(
     method_it = class_it->second.GetMethods().find("." + method_name);
     if (method_it == class_it->second.GetMethods().end()) {
       LOGGING_ERROR("Method not found: " + method_name);
-      return -1;
+      return nullptr;
     }
   }
 
-  Function method =
-      SelectBestFunction(memory_ptr, method_it->second, arguments);
+  return &method_it->second;
+}
+
+// Selects the overload of the method named by |method_name_object| of
+// |class_object| that fits |arguments| best. Returns nullptr if there is none.
+Function* LookupClassMethod(Object* memory_ptr, std::size_t class_object,
+                            std::size_t method_name_object,
+                            std::vector<std::size_t>& arguments,
+                            std::unordered_map<std::string, Class>& classes) {
+  std::vector<Function>* methods =
+      FindClassMethods(memory_ptr, class_object, method_name_object, classes);
+  if (methods == nullptr) return nullptr;
+  return SelectBestFunction(memory_ptr, *methods, arguments);
+}
+
+// Gets the builtin function named by |method_name_object| for the
+// INVOKE_METHOD with |cache|. Returns nullptr if the name is not a builtin.
+std::function<int(Memory*, std::vector<std::size_t>)>* LookupCachedBuiltin(
+    Object* memory_ptr, std::size_t method_name_object,
+    std::unordered_map<std::string,
+                       std::function<int(Memory*, std::vector<std::size_t>)>>&
+        builtin_functions,
+    InlineCache& cache) {
+  Object* name = GetOrigin(memory_ptr + method_name_object);
+  if (name->type == 0x05 && name->data.string_data == cache.name) {
+    if (cache.builtin != nullptr) inline_cache_hit_count++;
+    return cache.builtin;
+  }
 
-  auto function_arguments = method.GetParameters();
+  auto builtin_function =
+      builtin_functions.find(GetString(memory_ptr + method_name_object));
+  std::function<int(Memory*, std::vector<std::size_t>)>* builtin =
+      builtin_function == builtin_functions.end() ? nullptr
+                                                  : &builtin_function->second;
+  if (builtin != nullptr) inline_cache_miss_count++;
+  if (name->type == 0x05) {
+    cache.name = name->data.string_data;
+    cache.builtin = builtin;
+    cache.size = 0;
+  }
+  return builtin;
+}
+
+// Packs the types of |arguments| into the signature of an inline cache entry.
+// Returns false if they don't fit or the overload selection depends on more
+// than their types.
+bool GetArgumentSignature(Object* memory_ptr,
+                          const std::vector<std::size_t>& arguments,
+                          uint64_t& signature) {
+  if (arguments.size() > 9) return false;
+  signature = 0;
+  for (std::size_t i = 1; i < arguments.size(); i++) {
+    uint8_t type = GetOrigin(memory_ptr + arguments[i])->type;
+    if (type == 0x09) return false;
+    signature = signature << 8 | type;
+  }
+  return true;
+}
+
+// Selects the method called by the INVOKE_METHOD with |cache| like
+// LookupClassMethod(), answering repeated lookups for the same receiver class
+// and argument types from the cache.
+Function* LookupCachedClassMethod(
+    Object* memory_ptr, std::size_t class_object,
+    std::size_t method_name_object, std::vector<std::size_t>& arguments,
+    std::unordered_map<std::string, Class>& classes, InlineCache& cache) {
+  Object* class_name =
+      GetObject(memory_ptr + class_object)->FindMember(kClassNameSymbol);
+  if (class_name == nullptr || class_name->type != 0x05)
+    return LookupClassMethod(memory_ptr, class_object, method_name_object,
+                             arguments, classes);
+  const String* receiver_class = class_name->data.string_data;
+
+  bool has_signature = false;
+  uint64_t signature = 0;
+  for (std::size_t i = 0; i < cache.size; i++) {
+    InlineCacheEntry& entry = cache.entries[i];
+    if (entry.receiver_class != receiver_class) continue;
+    if (entry.has_signature) {
+      if (!has_signature &&
+          !GetArgumentSignature(memory_ptr, arguments, signature))
+        break;
+      has_signature = true;
+      if (entry.signature != signature) continue;
+    }
+    inline_cache_hit_count++;
+    return entry.method;
+  }
+
+  inline_cache_miss_count++;
+  std::vector<Function>* methods =
+      FindClassMethods(memory_ptr, class_object, method_name_object, classes);
+  if (methods == nullptr) return nullptr;
+  Function* method = SelectBestFunction(memory_ptr, *methods, arguments);
+  if (method == nullptr || cache.size == kInlineCacheSize) return method;
+
+  // Overloads are told apart by the argument types only if there are several.
+  InlineCacheEntry entry;
+  entry.receiver_class = receiver_class;
+  entry.method = method;
+  if (methods->size() > 1) {
+    if (!GetArgumentSignature(memory_ptr, arguments, entry.signature))
+      return method;
+    entry.has_signature = true;
+  }
+  cache.entries[cache.size++] = entry;
+  return method;
+}
+
+// Selects the overload of the method named by |method_name_object| of
+// |class_object| that fits |arguments| best, pushes its activation frame and
+// binds |arguments| to its parameters. The lookup goes through |cache| if the
+// call comes from an INVOKE_METHOD. Returns nullptr if the method can't be
+// entered.
+Function* EnterClassMethod(Memory* memory, std::size_t class_object,
+                           std::size_t method_name_object,
+                           std::vector<std::size_t>& arguments,
+                           std::unordered_map<std::string, Class>& classes,
+                           InlineCache* cache, std::size_t& frame_base) {
+  auto memory_ptr = memory->GetMemory().data();
+
+  Function* method =
+      cache == nullptr
+          ? LookupClassMethod(memory_ptr, class_object, method_name_object,
+                              arguments, classes)
+          : LookupCachedClassMethod(memory_ptr, class_object,
+                                    method_name_object, arguments, classes,
+                                    *cache);
+  if (method == nullptr) return nullptr;
+
+  // Pushes the activation frame of this invocation. Frame operands of the
+  // method are resolved against |frame_base| from here on.
+  frame_base = memory->PushFrame(method->GetFrame());
+  memory_ptr = memory->GetMemory().data();
+
+  std::vector<std::size_t> function_arguments =
+      ResolveArguments(method->GetParameters(), frame_base);
 
   // Return value.
   ObjectReference reference;
@@ -1022,7 +1491,7 @@ int InvokeClassMethod(
   SetReference(memory_ptr + function_arguments[0], reference);
 
   for (std::size_t i = 1;
-       i < (method.IsVariadic() ? function_arguments.size() - 1
+       i < (method->IsVariadic() ? function_arguments.size() - 1
                                 : function_arguments.size());
        i++) {
     auto argument_object = function_arguments[i];
@@ -1054,8 +1523,8 @@ int InvokeClassMethod(
                       GetUint64(memory_ptr + arguments[i]));
             break;
           case 0x05:
-            SetString(memory_ptr + argument_object,
-                      GetString(memory_ptr + arguments[i]));
+            CopyString(memory_ptr + argument_object,
+                       memory_ptr + arguments[i]);
             break;
           case 0x06:
             SetArrayContent(memory_ptr + argument_object,
@@ -1068,7 +1537,7 @@ int InvokeClassMethod(
           default:
             LOGGING_ERROR("Unsupported data type for function argument: " +
                           std::to_string(memory_ptr[argument_object].type));
-            return -1;
+            return nullptr;
         }
       } else {
         auto& reference = arguments[i];
@@ -1090,8 +1559,8 @@ int InvokeClassMethod(
                       GetUint64(memory_ptr + reference));
             break;
           case 0x05:
-            SetString(memory_ptr + argument_object,
-                      GetString(memory_ptr + reference));
+            CopyString(memory_ptr + argument_object,
+                       memory_ptr + reference);
             break;
           case 0x06:
             SetArrayContent(memory_ptr + argument_object,
@@ -1104,14 +1573,14 @@ int InvokeClassMethod(
           default:
             LOGGING_ERROR("Unsupported data type for function argument: " +
                           std::to_string(memory_ptr[reference].type));
-            return -1;
+            return nullptr;
         }
       }
     }
   }
 
-  if (method.IsVariadic()) {
-    auto array = new Memory();
+  if (method->IsVariadic()) {
+    auto array = Allocate<Memory>();
     memory->GetMemory()[function_arguments.back()].type = 0x06;
     memory->GetMemory()[function_arguments.back()].constant_type = true;
     memory->GetMemory()[function_arguments.back()].data.array_data = array;
@@ -1121,9 +1590,28 @@ int InvokeClassMethod(
     }
   }
 
-  const auto& instructions = method.GetCode();
-  auto instructions_ptr = instructions.data();
-  std::size_t instructions_size = instructions.size();
+  invoked_method_count++;
+  if (++call_depth > max_call_depth) max_call_depth = call_depth;
+
+  return method;
+}
+
+int InvokeClassMethod(
+    Memory* memory, std::size_t class_object, std::size_t method_name_object,
+    std::vector<size_t> arguments,
+    std::unordered_map<std::string, Class>& classes,
+    std::unordered_map<std::string,
+                       std::function<int(Memory*, std::vector<std::size_t>)>>&
+        builtin_functions) {
+  std::size_t frame_base = 0;
+  Function* method = EnterClassMethod(memory, class_object, method_name_object,
+                                      arguments, classes, nullptr, frame_base);
+  if (method == nullptr) return -1;
+  dispatch_depth++;
+
+  auto memory_ptr = memory->GetMemory().data();
+  auto instructions_ptr = method->GetCode().data();
+  std::size_t instructions_size = method->GetCode().size();
 
   // Save and set current_class_index for proper member access during method execution
   // This is critical for module class member initialization: when LOAD_MEMBER bytecode
@@ -1132,6 +1620,10 @@ int InvokeClassMethod(
   auto saved_current_class_index = current_class_index;
   current_class_index = class_object;
 
+  // Calls to methods of |memory| run in this loop. The state of the callers is
+  // kept on |call_stack| instead of the native stack.
+  std::vector<CallFrame> call_stack;
+
 #if defined(__GNUC__) || defined(__clang__)
   static const void* dispatch_table[] = {
       &&op_NOP,  &&op_NOP,           &&op_NOP,         &&op_NEW,  &&op_ARRAY,
@@ -1141,35 +1633,41 @@ int InvokeClassMethod(
       &&op_NOP,  &&op_EQUAL,         &&op_GOTO,        &&op_NOP,  &&op_NOP,
       &&op_NOP,  &&op_INVOKE_METHOD, &&op_LOAD_MEMBER, &&op_ADDI, &&op_SUBI,
       &&op_MULI, &&op_DIVI,          &&op_REMI,        &&op_ADDF, &&op_SUBF,
-      &&op_MULF, &&op_DIVF,          &&op_LOAD_MODULE_MEMBER, &&op_INVOKE_MODULE_METHOD, &&op_NEW_MODULE};
+      &&op_MULF, &&op_DIVF,          &&op_LOAD_MODULE_MEMBER, &&op_INVOKE_MODULE_METHOD, &&op_NEW_MODULE,
+      &&op_QUICK_ADDI, &&op_QUICK_ADDF, &&op_QUICK_SUBI, &&op_QUICK_SUBF,
+      &&op_QUICK_MULI, &&op_QUICK_MULF, &&op_QUICK_DIVI, &&op_QUICK_DIVF,
+      &&op_QUICK_REMI, &&op_QUICK_CMPI, &&op_QUICK_CMPF,
+      &&op_CMP_IF, &&op_INC_CMP_IF, &&op_ADD_STORE, &&op_SUB_STORE,
+      &&op_MUL_STORE, &&op_ADD_TO_LOCAL, &&op_LOAD_ELEMENT,
+      &&op_STORE_ELEMENT, &&op_CMPI, &&op_CMPF, &&op_CMP_IF, &&op_CMP_IF};
 #endif
 
-  struct Argument {
-    std::size_t operand1 = 0;
-    std::size_t operand2 = 0;
-    std::size_t operand3 = 0;
-    std::size_t operand4 = 0;
-  };
-
-  auto instructions_arguments = std::vector<Argument>(instructions_size);
-  for (int64_t i = 0; i < instructions_size; i++) {
-    const auto& instruction = instructions_ptr[i];
-    const auto& arguments = instruction.arguments;
-    auto& arg = instructions_arguments[i];
-
-    if (arguments.size() <= 0) continue;
-    arg.operand1 = arguments[0];
-    if (arguments.size() <= 1) continue;
-    arg.operand2 = arguments[1];
-    if (arguments.size() <= 2) continue;
-    arg.operand3 = arguments[2];
-    if (arguments.size() <= 3) continue;
-    arg.operand4 = arguments[3];
-  }
+  for (int64_t i = 0;; i++) {
+    if (i >= static_cast<int64_t>(instructions_size)) {
+      // Returns from the running method. Restore the previous
+      // current_class_index and resume the caller if there is one.
+      current_class_index = saved_current_class_index;
+      if (!method->GetFrame().empty()) memory->PopFrame(frame_base);
+      call_depth--;
+
+      if (call_stack.empty()) break;
+      const CallFrame& caller = call_stack.back();
+      method = caller.method;
+      instructions_ptr = method->GetCode().data();
+      instructions_size = method->GetCode().size();
+      frame_base = caller.frame_base;
+      saved_current_class_index = caller.saved_current_class_index;
+      i = caller.return_index;
+      call_stack.pop_back();
+      memory_ptr = memory->GetMemory().data();
+      continue;
+    }
 
-  for (int64_t i = 0; i < instructions_size; i++) {
-    const auto& instruction = instructions_ptr[i];
-    const auto arguments = instructions_arguments[i];
+    auto& instruction = instructions_ptr[i];
+    const std::size_t operand1 = ResolveOperand(instruction.operand1, frame_base);
+    const std::size_t operand2 = ResolveOperand(instruction.operand2, frame_base);
+    const std::size_t operand3 = ResolveOperand(instruction.operand3, frame_base);
+    const std::size_t operand4 = ResolveOperand(instruction.operand4, frame_base);
 
 #if defined(__GNUC__) || defined(__clang__)
     goto* dispatch_table[instruction.oper];
@@ -1178,300 +1676,409 @@ int InvokeClassMethod(
     NOP();
     continue;
   op_NEW:
-    NEW(memory_ptr, classes, arguments.operand1, arguments.operand2,
-        arguments.operand3, builtin_functions);
+    NEW(memory_ptr, classes, operand1, operand2,
+        operand3, builtin_functions);
     continue;
   op_ARRAY:
-    ARRAY(memory_ptr, arguments.operand1, arguments.operand2,
-          arguments.operand3, classes, builtin_functions);
+    ARRAY(memory_ptr, operand1, operand2,
+          operand3, classes, builtin_functions);
     continue;
   op_ADD:
-    if (memory_ptr[arguments.operand1].type == 0x02 &&
-        memory_ptr[arguments.operand2].type == 0x02 &&
-        memory_ptr[arguments.operand3].type == 0x02) {
-      int64_t* result = &memory_ptr[arguments.operand1].data.int_data;
-      const int64_t op1 = memory_ptr[arguments.operand2].data.int_data;
-      const int64_t op2 = memory_ptr[arguments.operand3].data.int_data;
-      *result = op1 + op2;
-      if (memory_ptr[arguments.operand1].constant_type &&
-          memory_ptr[arguments.operand2].constant_type &&
-          memory_ptr[arguments.operand3].constant_type) {
-        method.GetCode()[i].oper = _AQVM_OPERATOR_ADDI;
-      }
-    } else if (memory_ptr[arguments.operand1].type == 0x03 &&
-               memory_ptr[arguments.operand2].type == 0x03 &&
-               memory_ptr[arguments.operand3].type == 0x03) {
-      double* result = &memory_ptr[arguments.operand1].data.float_data;
-      const double op1 = memory_ptr[arguments.operand2].data.float_data;
-      const double op2 = memory_ptr[arguments.operand3].data.float_data;
-      *result = op1 + op2;
-      if (memory_ptr[arguments.operand1].constant_type &&
-          memory_ptr[arguments.operand2].constant_type &&
-          memory_ptr[arguments.operand3].constant_type) {
-        method.GetCode()[i].oper = _AQVM_OPERATOR_ADDF;
-      }
-    } else {
-      ADD(memory_ptr, arguments.operand1, arguments.operand2,
-          arguments.operand3);
-    }
+    ADD(memory_ptr, operand1, operand2,
+        operand3);
+    QuickenArithmetic(memory_ptr, instruction, operand1, operand2,
+                          operand3, _AQVM_OPERATOR_QUICK_ADDI,
+                      _AQVM_OPERATOR_QUICK_ADDF);
     continue;
   op_SUB:
-    if (memory_ptr[arguments.operand1].type == 0x02 &&
-        memory_ptr[arguments.operand2].type == 0x02 &&
-        memory_ptr[arguments.operand3].type == 0x02) {
-      int64_t* result = &memory_ptr[arguments.operand1].data.int_data;
-      const int64_t op1 = memory_ptr[arguments.operand2].data.int_data;
-      const int64_t op2 = memory_ptr[arguments.operand3].data.int_data;
-      *result = op1 - op2;
-      if (memory_ptr[arguments.operand1].constant_type &&
-          memory_ptr[arguments.operand2].constant_type &&
-          memory_ptr[arguments.operand3].constant_type) {
-        method.GetCode()[i].oper = _AQVM_OPERATOR_SUBI;
-      }
-    } else if (memory_ptr[arguments.operand1].type == 0x03 &&
-               memory_ptr[arguments.operand2].type == 0x03 &&
-               memory_ptr[arguments.operand3].type == 0x03) {
-      double* result = &memory_ptr[arguments.operand1].data.float_data;
-      const double op1 = memory_ptr[arguments.operand2].data.float_data;
-      const double op2 = memory_ptr[arguments.operand3].data.float_data;
-      *result = op1 - op2;
-      if (memory_ptr[arguments.operand1].constant_type &&
-          memory_ptr[arguments.operand2].constant_type &&
-          memory_ptr[arguments.operand3].constant_type) {
-        method.GetCode()[i].oper = _AQVM_OPERATOR_SUBF;
-      }
-    } else {
-      SUB(memory_ptr, arguments.operand1, arguments.operand2,
-          arguments.operand3);
-    }
+    SUB(memory_ptr, operand1, operand2,
+        operand3);
+    QuickenArithmetic(memory_ptr, instruction, operand1, operand2,
+                          operand3, _AQVM_OPERATOR_QUICK_SUBI,
+                      _AQVM_OPERATOR_QUICK_SUBF);
     continue;
   op_MUL:
-    if (memory_ptr[arguments.operand1].type == 0x02 &&
-        memory_ptr[arguments.operand2].type == 0x02 &&
-        memory_ptr[arguments.operand3].type == 0x02) {
-      int64_t* result = &memory_ptr[arguments.operand1].data.int_data;
-      const int64_t op1 = memory_ptr[arguments.operand2].data.int_data;
-      const int64_t op2 = memory_ptr[arguments.operand3].data.int_data;
-      *result = op1 * op2;
-      if (memory_ptr[arguments.operand1].constant_type &&
-          memory_ptr[arguments.operand2].constant_type &&
-          memory_ptr[arguments.operand3].constant_type) {
-        method.GetCode()[i].oper = _AQVM_OPERATOR_MULI;
-      }
-    } else if (memory_ptr[arguments.operand1].type == 0x03 &&
-               memory_ptr[arguments.operand2].type == 0x03 &&
-               memory_ptr[arguments.operand3].type == 0x03) {
-      double* result = &memory_ptr[arguments.operand1].data.float_data;
-      const double op1 = memory_ptr[arguments.operand2].data.float_data;
-      const double op2 = memory_ptr[arguments.operand3].data.float_data;
-      *result = op1 * op2;
-      if (memory_ptr[arguments.operand1].constant_type &&
-          memory_ptr[arguments.operand2].constant_type &&
-          memory_ptr[arguments.operand3].constant_type) {
-        method.GetCode()[i].oper = _AQVM_OPERATOR_MULF;
-      }
-    } else {
-      MUL(memory_ptr, arguments.operand1, arguments.operand2,
-          arguments.operand3);
-    }
+    MUL(memory_ptr, operand1, operand2,
+        operand3);
+    QuickenArithmetic(memory_ptr, instruction, operand1, operand2,
+                          operand3, _AQVM_OPERATOR_QUICK_MULI,
+                      _AQVM_OPERATOR_QUICK_MULF);
     continue;
   op_DIV:
-    if (memory_ptr[arguments.operand1].type == 0x02 &&
-        memory_ptr[arguments.operand2].type == 0x02 &&
-        memory_ptr[arguments.operand3].type == 0x02) {
-      int64_t* result = &memory_ptr[arguments.operand1].data.int_data;
-      const int64_t op1 = memory_ptr[arguments.operand2].data.int_data;
-      const int64_t op2 = memory_ptr[arguments.operand3].data.int_data;
-      *result = op1 / op2;
-      if (memory_ptr[arguments.operand1].constant_type &&
-          memory_ptr[arguments.operand2].constant_type &&
-          memory_ptr[arguments.operand3].constant_type) {
-        method.GetCode()[i].oper = _AQVM_OPERATOR_DIVI;
-      }
-    } else if (memory_ptr[arguments.operand1].type == 0x03 &&
-               memory_ptr[arguments.operand2].type == 0x03 &&
-               memory_ptr[arguments.operand3].type == 0x03) {
-      double* result = &memory_ptr[arguments.operand1].data.float_data;
-      const double op1 = memory_ptr[arguments.operand2].data.float_data;
-      const double op2 = memory_ptr[arguments.operand3].data.float_data;
-      *result = op1 / op2;
-      if (memory_ptr[arguments.operand1].constant_type &&
-          memory_ptr[arguments.operand2].constant_type &&
-          memory_ptr[arguments.operand3].constant_type) {
-        method.GetCode()[i].oper = _AQVM_OPERATOR_DIVF;
-      }
-    } else {
-      DIV(memory_ptr, arguments.operand1, arguments.operand2,
-          arguments.operand3);
-    }
+    DIV(memory_ptr, operand1, operand2,
+        operand3);
+    QuickenArithmetic(memory_ptr, instruction, operand1, operand2,
+                          operand3, _AQVM_OPERATOR_QUICK_DIVI,
+                      _AQVM_OPERATOR_QUICK_DIVF);
     continue;
   op_REM:
-    if (memory_ptr[arguments.operand1].type == 0x02 &&
-        memory_ptr[arguments.operand2].type == 0x02 &&
-        memory_ptr[arguments.operand3].type == 0x02) {
-      int64_t* result = &memory_ptr[arguments.operand1].data.int_data;
-      const int64_t op1 = memory_ptr[arguments.operand2].data.int_data;
-      const int64_t op2 = memory_ptr[arguments.operand3].data.int_data;
-      *result = op1 % op2;
-      if (memory_ptr[arguments.operand1].constant_type &&
-          memory_ptr[arguments.operand2].constant_type &&
-          memory_ptr[arguments.operand3].constant_type) {
-        method.GetCode()[i].oper = _AQVM_OPERATOR_REMI;
-      }
-    } else {
-      REM(memory_ptr, arguments.operand1, arguments.operand2,
-          arguments.operand3);
-    }
+    REM(memory_ptr, operand1, operand2,
+        operand3);
+    QuickenArithmetic(memory_ptr, instruction, operand1, operand2,
+                          operand3, _AQVM_OPERATOR_QUICK_REMI,
+                      _AQVM_OPERATOR_NOP);
     continue;
   op_NEG:
-    if (memory_ptr[arguments.operand2].type == 0x02) {
-      SetLong(memory_ptr + arguments.operand1,
-              -memory_ptr[arguments.operand2].data.int_data);
-    } else if (memory_ptr[arguments.operand2].type == 0x03) {
-      SetDouble(memory_ptr + arguments.operand1,
-                -memory_ptr[arguments.operand2].data.float_data);
+    if (memory_ptr[operand2].type == 0x02) {
+      SetLong(memory_ptr + operand1,
+              -memory_ptr[operand2].data.int_data);
+    } else if (memory_ptr[operand2].type == 0x03) {
+      SetDouble(memory_ptr + operand1,
+                -memory_ptr[operand2].data.float_data);
     } else {
-      NEG(memory_ptr, arguments.operand1, arguments.operand2);
+      NEG(memory_ptr, operand1, operand2);
     }
     continue;
   op_SHL:
-    SHL(memory_ptr, arguments.operand1, arguments.operand2, arguments.operand3);
+    SHL(memory_ptr, operand1, operand2, operand3);
     continue;
   op_SHR:
-    SHR(memory_ptr, arguments.operand1, arguments.operand2, arguments.operand3);
+    SHR(memory_ptr, operand1, operand2, operand3);
     continue;
   op_REFER:
-    REFER(memory, arguments.operand1, arguments.operand2);
+    REFER(memory, operand1, operand2);
     continue;
   op_IF:
-    i = IF(memory_ptr, arguments.operand1, arguments.operand2,
-           arguments.operand3);
+    i = IF(memory_ptr, operand1, operand2,
+           operand3);
     i--;
     continue;
   op_AND:
-    AND(memory_ptr, arguments.operand1, arguments.operand2, arguments.operand3);
+    AND(memory_ptr, operand1, operand2, operand3);
     continue;
   op_OR:
-    OR(memory_ptr, arguments.operand1, arguments.operand2, arguments.operand3);
+    OR(memory_ptr, operand1, operand2, operand3);
     continue;
   op_XOR:
-    XOR(memory_ptr, arguments.operand1, arguments.operand2, arguments.operand3);
+    XOR(memory_ptr, operand1, operand2, operand3);
     continue;
   op_CMP:
-    CMP(memory_ptr, arguments.operand1, arguments.operand2, arguments.operand3,
-        arguments.operand4);
+    CMP(memory_ptr, operand1, operand2,
+        operand3, operand4);
+    QuickenCompare(memory_ptr, instruction, operand1, operand3, operand4);
     continue;
   op_EQUAL:
-    if (memory_ptr[arguments.operand2].type == 0x02) {
-      SetLong(memory_ptr + arguments.operand1,
-              memory_ptr[arguments.operand2].data.int_data);
-    } else if (memory_ptr[arguments.operand2].type == 0x03) {
-      SetDouble(memory_ptr + arguments.operand1,
-                memory_ptr[arguments.operand2].data.float_data);
+    if (memory_ptr[operand2].type == 0x02) {
+      SetLong(memory_ptr + operand1,
+              memory_ptr[operand2].data.int_data);
+    } else if (memory_ptr[operand2].type == 0x03) {
+      SetDouble(memory_ptr + operand1,
+                memory_ptr[operand2].data.float_data);
     } else {
-      EQUAL(memory_ptr, arguments.operand1, arguments.operand2);
+      EQUAL(memory_ptr, operand1, operand2);
     }
     continue;
   op_GOTO:
-    i = GOTO(memory_ptr, arguments.operand1);
+    i = GOTO(instruction.operand1);
     i--;
+    CollectAtSafePoint();
     continue;
   op_INVOKE_METHOD: {
-    auto origin_class_index = current_class_index;
-    current_class_index = arguments.operand1;
-    INVOKE_METHOD(memory, classes, builtin_functions,
-                  instructions_ptr[i].arguments);
-    current_class_index = origin_class_index;
+    CollectAtSafePoint();
+    auto call_arguments = GetOperands(&instruction, frame_base);
+    InlineCache& cache = method->GetInlineCache(i);
+    i += instruction.GetExtensionSize();
+    if (call_arguments.size() < 3) INTERNAL_ERROR("Invalid arguments.");
+
+    auto builtin_function = LookupCachedBuiltin(
+        memory_ptr, call_arguments[1], builtin_functions, cache);
+    if (builtin_function != nullptr) {
+      auto origin_class_index = current_class_index;
+      current_class_index = operand1;
+      call_arguments.erase(call_arguments.begin(), call_arguments.begin() + 2);
+      (*builtin_function)(memory, call_arguments);
+      current_class_index = origin_class_index;
+      memory_ptr = memory->GetMemory().data();
+      continue;
+    }
+
+    // Enters the callee in this loop.
+    std::size_t callee_object = call_arguments[0];
+    std::size_t callee_name_object = call_arguments[1];
+    call_arguments.erase(call_arguments.begin(), call_arguments.begin() + 2);
+    std::size_t callee_frame_base = 0;
+    Function* callee =
+        EnterClassMethod(memory, callee_object, callee_name_object,
+                         call_arguments, classes, &cache, callee_frame_base);
+    if (callee == nullptr) continue;
+
+    call_stack.push_back({method, i, frame_base, saved_current_class_index});
+    saved_current_class_index = current_class_index;
+    current_class_index = callee_object;
+    method = callee;
+    instructions_ptr = method->GetCode().data();
+    instructions_size = method->GetCode().size();
+    frame_base = callee_frame_base;
+    memory_ptr = memory->GetMemory().data();
+    i = -1;
     continue;
   }
   op_LOAD_MEMBER:
-    if (arguments.operand2 == 0) {
-      LOAD_MEMBER(memory, classes, arguments.operand1, current_class_index,
-                  arguments.operand3);
+    if (operand2 == 0) {
+      LOAD_MEMBER(memory, classes, operand1, current_class_index,
+                  operand3);
     } else {
-      LOAD_MEMBER(memory, classes, arguments.operand1, arguments.operand2,
-                  arguments.operand3);
+      LOAD_MEMBER(memory, classes, operand1, operand2,
+                  operand3);
     }
     continue;
 
   op_ADDI: {
-    int64_t* result = &memory_ptr[arguments.operand1].data.int_data;
-    const int64_t op1 = memory_ptr[arguments.operand2].data.int_data;
-    const int64_t op2 = memory_ptr[arguments.operand3].data.int_data;
+    int64_t* result = &memory_ptr[operand1].data.int_data;
+    const int64_t op1 = memory_ptr[operand2].data.int_data;
+    const int64_t op2 = memory_ptr[operand3].data.int_data;
     *result = op1 + op2;
     continue;
   }
   op_SUBI: {
-    int64_t* result = &memory_ptr[arguments.operand1].data.int_data;
-    const int64_t op1 = memory_ptr[arguments.operand2].data.int_data;
-    const int64_t op2 = memory_ptr[arguments.operand3].data.int_data;
+    int64_t* result = &memory_ptr[operand1].data.int_data;
+    const int64_t op1 = memory_ptr[operand2].data.int_data;
+    const int64_t op2 = memory_ptr[operand3].data.int_data;
     *result = op1 - op2;
     continue;
   }
   op_MULI: {
-    int64_t* result = &memory_ptr[arguments.operand1].data.int_data;
-    const int64_t op1 = memory_ptr[arguments.operand2].data.int_data;
-    const int64_t op2 = memory_ptr[arguments.operand3].data.int_data;
+    int64_t* result = &memory_ptr[operand1].data.int_data;
+    const int64_t op1 = memory_ptr[operand2].data.int_data;
+    const int64_t op2 = memory_ptr[operand3].data.int_data;
     *result = op1 * op2;
     continue;
   }
   op_DIVI: {
-    int64_t* result = &memory_ptr[arguments.operand1].data.int_data;
-    const int64_t op1 = memory_ptr[arguments.operand2].data.int_data;
-    const int64_t op2 = memory_ptr[arguments.operand3].data.int_data;
+    int64_t* result = &memory_ptr[operand1].data.int_data;
+    const int64_t op1 = memory_ptr[operand2].data.int_data;
+    const int64_t op2 = memory_ptr[operand3].data.int_data;
     *result = op1 / op2;
     continue;
   }
   op_REMI: {
-    int64_t* result = &memory_ptr[arguments.operand1].data.int_data;
-    const int64_t op1 = memory_ptr[arguments.operand2].data.int_data;
-    const int64_t op2 = memory_ptr[arguments.operand3].data.int_data;
+    int64_t* result = &memory_ptr[operand1].data.int_data;
+    const int64_t op1 = memory_ptr[operand2].data.int_data;
+    const int64_t op2 = memory_ptr[operand3].data.int_data;
     *result = op1 % op2;
     continue;
   }
   op_ADDF: {
-    double* result = &memory_ptr[arguments.operand1].data.float_data;
-    const double op1 = memory_ptr[arguments.operand2].data.float_data;
-    const double op2 = memory_ptr[arguments.operand3].data.float_data;
+    double* result = &memory_ptr[operand1].data.float_data;
+    const double op1 = memory_ptr[operand2].data.float_data;
+    const double op2 = memory_ptr[operand3].data.float_data;
     *result = op1 + op2;
     continue;
   }
   op_SUBF: {
-    double* result = &memory_ptr[arguments.operand1].data.float_data;
-    const double op1 = memory_ptr[arguments.operand2].data.float_data;
-    const double op2 = memory_ptr[arguments.operand3].data.float_data;
+    double* result = &memory_ptr[operand1].data.float_data;
+    const double op1 = memory_ptr[operand2].data.float_data;
+    const double op2 = memory_ptr[operand3].data.float_data;
     *result = op1 - op2;
     continue;
   }
   op_MULF: {
-    double* result = &memory_ptr[arguments.operand1].data.float_data;
-    const double op1 = memory_ptr[arguments.operand2].data.float_data;
-    const double op2 = memory_ptr[arguments.operand3].data.float_data;
+    double* result = &memory_ptr[operand1].data.float_data;
+    const double op1 = memory_ptr[operand2].data.float_data;
+    const double op2 = memory_ptr[operand3].data.float_data;
     *result = op1 * op2;
     continue;
   }
   op_DIVF: {
-    double* result = &memory_ptr[arguments.operand1].data.float_data;
-    const double op1 = memory_ptr[arguments.operand2].data.float_data;
-    const double op2 = memory_ptr[arguments.operand3].data.float_data;
+    double* result = &memory_ptr[operand1].data.float_data;
+    const double op1 = memory_ptr[operand2].data.float_data;
+    const double op2 = memory_ptr[operand3].data.float_data;
     *result = op1 / op2;
     continue;
   }
+  op_QUICK_ADDI:
+    if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x02)) {
+      memory_ptr[operand1].data.int_data =
+          memory_ptr[operand2].data.int_data +
+          memory_ptr[operand3].data.int_data;
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_ADD);
+    goto op_ADD;
+  op_QUICK_ADDF:
+    if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x03)) {
+      memory_ptr[operand1].data.float_data =
+          memory_ptr[operand2].data.float_data +
+          memory_ptr[operand3].data.float_data;
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_ADD);
+    goto op_ADD;
+  op_QUICK_SUBI:
+    if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x02)) {
+      memory_ptr[operand1].data.int_data =
+          memory_ptr[operand2].data.int_data -
+          memory_ptr[operand3].data.int_data;
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_SUB);
+    goto op_SUB;
+  op_QUICK_SUBF:
+    if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x03)) {
+      memory_ptr[operand1].data.float_data =
+          memory_ptr[operand2].data.float_data -
+          memory_ptr[operand3].data.float_data;
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_SUB);
+    goto op_SUB;
+  op_QUICK_MULI:
+    if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x02)) {
+      memory_ptr[operand1].data.int_data =
+          memory_ptr[operand2].data.int_data *
+          memory_ptr[operand3].data.int_data;
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_MUL);
+    goto op_MUL;
+  op_QUICK_MULF:
+    if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x03)) {
+      memory_ptr[operand1].data.float_data =
+          memory_ptr[operand2].data.float_data *
+          memory_ptr[operand3].data.float_data;
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_MUL);
+    goto op_MUL;
+  op_QUICK_DIVI:
+    if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x02)) {
+      memory_ptr[operand1].data.int_data =
+          memory_ptr[operand2].data.int_data /
+          memory_ptr[operand3].data.int_data;
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_DIV);
+    goto op_DIV;
+  op_QUICK_DIVF:
+    if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x03)) {
+      memory_ptr[operand1].data.float_data =
+          memory_ptr[operand2].data.float_data /
+          memory_ptr[operand3].data.float_data;
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_DIV);
+    goto op_DIV;
+  op_QUICK_REMI:
+    if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x02)) {
+      memory_ptr[operand1].data.int_data =
+          memory_ptr[operand2].data.int_data %
+          memory_ptr[operand3].data.int_data;
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_REM);
+    goto op_REM;
+  op_QUICK_CMPI:
+    if (HasCompareTypes(memory_ptr, operand1, operand3, operand4, 0x02)) {
+      memory_ptr[operand1].data.byte_data = CompareValues(
+          operand2, memory_ptr[operand3].data.int_data,
+          memory_ptr[operand4].data.int_data);
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_CMP);
+    goto op_CMP;
+  op_QUICK_CMPF:
+    if (HasCompareTypes(memory_ptr, operand1, operand3, operand4, 0x03)) {
+      memory_ptr[operand1].data.byte_data = CompareValues(
+          operand2, memory_ptr[operand3].data.float_data,
+          memory_ptr[operand4].data.float_data);
+      continue;
+    }
+    Deoptimize(instruction, _AQVM_OPERATOR_CMP);
+    goto op_CMP;
+  op_CMPI:
+    memory_ptr[operand1].data.byte_data =
+        CompareValues(operand2, memory_ptr[operand3].data.int_data,
+                      memory_ptr[operand4].data.int_data);
+    continue;
+  op_CMPF:
+    memory_ptr[operand1].data.byte_data =
+        CompareValues(operand2, memory_ptr[operand3].data.float_data,
+                      memory_ptr[operand4].data.float_data);
+    continue;
+  op_CMP_IF: {
+    // A backward branch is a safe point like GOTO, as it may close a loop.
+    int64_t target = CompareAndBranch(memory_ptr, &instruction, frame_base);
+    if (target <= i) CollectAtSafePoint();
+    i = target;
+    i--;
+    continue;
+  }
+  op_INC_CMP_IF: {
+    memory_ptr[operand1].data.int_data =
+        memory_ptr[operand2].data.int_data + memory_ptr[operand3].data.int_data;
+    // The fused instruction replaces the back edge GOTO of its loop.
+    int64_t target = CompareAndBranch(
+        memory_ptr, instructions_ptr + instructions_ptr[i + 1].operand1,
+        frame_base);
+    if (target <= i) CollectAtSafePoint();
+    i = target;
+    i--;
+    continue;
+  }
+  op_ADD_STORE:
+    StoreArithmetic(
+        memory_ptr, operand1, operand2, operand3,
+        ResolveOperand(instructions_ptr[i + 1].operand1, frame_base),
+        [](auto a, auto b) { return a + b; }, ADD);
+    i++;
+    continue;
+  op_SUB_STORE:
+    StoreArithmetic(
+        memory_ptr, operand1, operand2, operand3,
+        ResolveOperand(instructions_ptr[i + 1].operand1, frame_base),
+        [](auto a, auto b) { return a - b; }, SUB);
+    i++;
+    continue;
+  op_MUL_STORE:
+    StoreArithmetic(
+        memory_ptr, operand1, operand2, operand3,
+        ResolveOperand(instructions_ptr[i + 1].operand1, frame_base),
+        [](auto a, auto b) { return a * b; }, MUL);
+    i++;
+    continue;
+  op_ADD_TO_LOCAL: {
+    const std::size_t local =
+        ResolveOperand(instructions_ptr[i + 1].operand1, frame_base);
+    if (memory_ptr[operand2].type == 0x02) {
+      SetLong(memory_ptr + operand1, memory_ptr[operand2].data.int_data);
+    } else {
+      EQUAL(memory_ptr, operand1, operand2);
+    }
+    memory_ptr[local].data.int_data =
+        memory_ptr[ResolveOperand(instructions_ptr[i + 1].operand2,
+                                  frame_base)]
+            .data.int_data +
+        memory_ptr[ResolveOperand(instructions_ptr[i + 1].operand3,
+                                  frame_base)]
+            .data.int_data;
+    i++;
+    continue;
+  }
+  op_LOAD_ELEMENT:
+    LOAD_ELEMENT(memory_ptr, operand1, operand2, operand3, classes,
+                 builtin_functions);
+    continue;
+  op_STORE_ELEMENT:
+    STORE_ELEMENT(memory_ptr, operand1, operand2, operand3,
+                  ResolveOperand(instructions_ptr[i + 1].operand2, frame_base),
+                  classes, builtin_functions);
+    i++;
+    continue;
   op_LOAD_MODULE_MEMBER: {
     // operand1: result index in local memory
     // operand2: module pointer index in local memory
     // operand3: member name index in local memory
-    if (memory_ptr[arguments.operand2].type != 0x0A) {
+    if (memory_ptr[operand2].type != 0x0A) {
       LOGGING_ERROR("LOAD_MODULE_MEMBER: Module pointer expected at operand2");
       continue;
     }
-    Interpreter* module_interp = static_cast<Interpreter*>(memory_ptr[arguments.operand2].data.pointer_data);
+    Interpreter* module_interp = static_cast<Interpreter*>(memory_ptr[operand2].data.pointer_data);
     if (module_interp == nullptr) {
       LOGGING_ERROR("LOAD_MODULE_MEMBER: Null module interpreter");
       continue;
     }
     
-    std::string member_name = GetString(memory_ptr + arguments.operand3);
+    std::string member_name = GetString(memory_ptr + operand3);
     auto& module_vars = module_interp->context.variables;
     auto var_it = module_vars.find("#" + member_name);
     if (var_it == module_vars.end()) {
@@ -1480,23 +2087,24 @@ int InvokeClassMethod(
     }
     
     // Create reference to module variable
-    ObjectReference* ref = new ObjectReference();
+    ObjectReference* ref = Allocate<ObjectReference>();
     ref->is_class = false;
     ref->memory.memory = module_interp->global_memory;
     ref->index.index = var_it->second;
     
-    memory_ptr[arguments.operand1].type = 0x07;
-    memory_ptr[arguments.operand1].constant_type = false;
-    memory_ptr[arguments.operand1].data.reference_data = ref;
+    memory_ptr[operand1].type = 0x07;
+    memory_ptr[operand1].constant_type = false;
+    memory_ptr[operand1].data.reference_data = ref;
     continue;
   }
   op_INVOKE_MODULE_METHOD: {
-    // Arguments in instruction.arguments vector:
+    // Operands of the instruction and its extension words:
     // [0]: module pointer index
     // [1]: method name index  
     // [2]: return value index
     // [3+]: method arguments
-    auto& args = instructions_ptr[i].arguments;
+    auto args = GetOperands(&instruction, frame_base);
+    i += instruction.GetExtensionSize();
     if (args.size() < 3) {
       LOGGING_ERROR("INVOKE_MODULE_METHOD: Insufficient arguments");
       continue;
@@ -1516,7 +2124,6 @@ int InvokeClassMethod(
     
     // Create references in module memory for all arguments
     auto module_memory = module_interp->global_memory;
-    auto module_ptr = module_memory->GetMemory().data();
     
     std::vector<std::size_t> module_args;
     // Return value reference
@@ -1529,23 +2136,33 @@ int InvokeClassMethod(
       module_args.push_back(arg_ref_idx);
     }
     
+    // Adding the references may have moved the module memory.
+    auto module_ptr = module_memory->GetMemory().data();
+    
     // Check if it's a lambda (variable holding function name)
     auto& module_vars = module_interp->context.variables;
     auto var_it = module_vars.find("#" + method_name);
     if (var_it != module_vars.end() && module_ptr[var_it->second].type == 0x05) {
       // It's a lambda stored as a variable - get the actual function name
-      method_name = *module_ptr[var_it->second].data.string_data;
+      method_name = module_ptr[var_it->second].data.string_data->Get();
     }
     
     // Invoke in module interpreter's context
     std::size_t method_name_idx = module_memory->AddString(method_name);
     InvokeClassMethod(module_memory, 2, method_name_idx, module_args,
                      module_interp->classes, module_interp->builtin_functions);
+
+    // The slots of the call are reused by the next call, so calling into a
+    // module doesn't grow its memory.
+    module_memory->Release(method_name_idx);
+    for (auto it = module_args.rbegin(); it != module_args.rend(); ++it)
+      module_memory->Release(*it);
+    memory_ptr = memory->GetMemory().data();
     continue;
   }
   op_NEW_MODULE: {
     // Format: [result, size, type, module_ptr]
-    auto& args = instructions_ptr[i].arguments;
+    auto args = GetOperands(&instruction, frame_base);
     if (args.size() < 4) {
       LOGGING_ERROR("NEW_MODULE: Insufficient arguments");
       continue;
@@ -1576,6 +2193,7 @@ int InvokeClassMethod(
     if (result != 0) {
       LOGGING_ERROR("NEW_MODULE: Failed to create module class instance");
     }
+    memory_ptr = memory->GetMemory().data();
     continue;
   }
 #else
@@ -1586,278 +2204,426 @@ int InvokeClassMethod(
         NOP();
         break;
       case _AQVM_OPERATOR_NEW:
-        NEW(memory_ptr, classes, arguments.operand1, arguments.operand2,
-            arguments.operand3, builtin_functions);
+        NEW(memory_ptr, classes, operand1, operand2,
+            operand3, builtin_functions);
         break;
       case _AQVM_OPERATOR_ARRAY:
-        ARRAY(memory_ptr, arguments.operand1, arguments.operand2,
-              arguments.operand3, classes, builtin_functions);
+        ARRAY(memory_ptr, operand1, operand2,
+              operand3, classes, builtin_functions);
         break;
       case _AQVM_OPERATOR_ADD:
-        if (memory_ptr[arguments.operand1].type == 0x02 &&
-            memory_ptr[arguments.operand2].type == 0x02 &&
-            memory_ptr[arguments.operand3].type == 0x02) {
-          memory_ptr[arguments.operand1].data.int_data =
-              memory_ptr[arguments.operand2].data.int_data +
-              memory_ptr[arguments.operand3].data.int_data;
-          if (memory_ptr[arguments.operand1].constant_type &&
-              memory_ptr[arguments.operand2].constant_type &&
-              memory_ptr[arguments.operand3].constant_type) {
-            method.GetCode()[i].oper = _AQVM_OPERATOR_ADDI;
-          }
-        } else if (memory_ptr[arguments.operand1].type == 0x03 &&
-                   memory_ptr[arguments.operand2].type == 0x03 &&
-                   memory_ptr[arguments.operand3].type == 0x03) {
-          memory_ptr[arguments.operand1].data.float_data =
-              memory_ptr[arguments.operand2].data.float_data +
-              memory_ptr[arguments.operand3].data.float_data;
-          if (memory_ptr[arguments.operand1].constant_type &&
-              memory_ptr[arguments.operand2].constant_type &&
-              memory_ptr[arguments.operand3].constant_type) {
-            method.GetCode()[i].oper = _AQVM_OPERATOR_ADDF;
-          }
-        } else {
-          ADD(memory_ptr, arguments.operand1, arguments.operand2,
-              arguments.operand3);
-        }
+        ADD(memory_ptr, operand1, operand2,
+            operand3);
+        QuickenArithmetic(memory_ptr, instruction, operand1, operand2,
+                          operand3, _AQVM_OPERATOR_QUICK_ADDI,
+                          _AQVM_OPERATOR_QUICK_ADDF);
         break;
       case _AQVM_OPERATOR_SUB:
-        if (memory_ptr[arguments.operand1].type == 0x02 &&
-            memory_ptr[arguments.operand2].type == 0x02 &&
-            memory_ptr[arguments.operand3].type == 0x02) {
-          memory_ptr[arguments.operand1].data.int_data =
-              memory_ptr[arguments.operand2].data.int_data -
-              memory_ptr[arguments.operand3].data.int_data;
-          if (memory_ptr[arguments.operand1].constant_type &&
-              memory_ptr[arguments.operand2].constant_type &&
-              memory_ptr[arguments.operand3].constant_type) {
-            method.GetCode()[i].oper = _AQVM_OPERATOR_SUBI;
-          }
-        } else if (memory_ptr[arguments.operand1].type == 0x03 &&
-                   memory_ptr[arguments.operand2].type == 0x03 &&
-                   memory_ptr[arguments.operand3].type == 0x03) {
-          memory_ptr[arguments.operand1].data.float_data =
-              memory_ptr[arguments.operand2].data.float_data -
-              memory_ptr[arguments.operand3].data.float_data;
-          if (memory_ptr[arguments.operand1].constant_type &&
-              memory_ptr[arguments.operand2].constant_type &&
-              memory_ptr[arguments.operand3].constant_type) {
-            method.GetCode()[i].oper = _AQVM_OPERATOR_SUBF;
-          }
-        } else {
-          SUB(memory_ptr, arguments.operand1, arguments.operand2,
-              arguments.operand3);
-        }
+        SUB(memory_ptr, operand1, operand2,
+            operand3);
+        QuickenArithmetic(memory_ptr, instruction, operand1, operand2,
+                          operand3, _AQVM_OPERATOR_QUICK_SUBI,
+                          _AQVM_OPERATOR_QUICK_SUBF);
         break;
       case _AQVM_OPERATOR_MUL:
-        if (memory_ptr[arguments.operand1].type == 0x02 &&
-            memory_ptr[arguments.operand2].type == 0x02 &&
-            memory_ptr[arguments.operand3].type == 0x02) {
-          memory_ptr[arguments.operand1].data.int_data =
-              memory_ptr[arguments.operand2].data.int_data *
-              memory_ptr[arguments.operand3].data.int_data;
-          if (memory_ptr[arguments.operand1].constant_type &&
-              memory_ptr[arguments.operand2].constant_type &&
-              memory_ptr[arguments.operand3].constant_type) {
-            method.GetCode()[i].oper = _AQVM_OPERATOR_MULI;
-          }
-        } else if (memory_ptr[arguments.operand1].type == 0x03 &&
-                   memory_ptr[arguments.operand2].type == 0x03 &&
-                   memory_ptr[arguments.operand3].type == 0x03) {
-          memory_ptr[arguments.operand1].data.float_data =
-              memory_ptr[arguments.operand2].data.float_data *
-              memory_ptr[arguments.operand3].data.float_data;
-          if (memory_ptr[arguments.operand1].constant_type &&
-              memory_ptr[arguments.operand2].constant_type &&
-              memory_ptr[arguments.operand3].constant_type) {
-            method.GetCode()[i].oper = _AQVM_OPERATOR_MULF;
-          }
-        } else {
-          MUL(memory_ptr, arguments.operand1, arguments.operand2,
-              arguments.operand3);
-        }
+        MUL(memory_ptr, operand1, operand2,
+            operand3);
+        QuickenArithmetic(memory_ptr, instruction, operand1, operand2,
+                          operand3, _AQVM_OPERATOR_QUICK_MULI,
+                          _AQVM_OPERATOR_QUICK_MULF);
         break;
       case _AQVM_OPERATOR_DIV:
-        if (memory_ptr[arguments.operand1].type == 0x02 &&
-            memory_ptr[arguments.operand2].type == 0x02 &&
-            memory_ptr[arguments.operand3].type == 0x02) {
-          memory_ptr[arguments.operand1].data.int_data =
-              memory_ptr[arguments.operand2].data.int_data /
-              memory_ptr[arguments.operand3].data.int_data;
-          if (memory_ptr[arguments.operand1].constant_type &&
-              memory_ptr[arguments.operand2].constant_type &&
-              memory_ptr[arguments.operand3].constant_type) {
-            method.GetCode()[i].oper = _AQVM_OPERATOR_DIVI;
-          }
-        } else if (memory_ptr[arguments.operand1].type == 0x03 &&
-                   memory_ptr[arguments.operand2].type == 0x03 &&
-                   memory_ptr[arguments.operand3].type == 0x03) {
-          memory_ptr[arguments.operand1].data.float_data =
-              memory_ptr[arguments.operand2].data.float_data /
-              memory_ptr[arguments.operand3].data.float_data;
-          if (memory_ptr[arguments.operand1].constant_type &&
-              memory_ptr[arguments.operand2].constant_type &&
-              memory_ptr[arguments.operand3].constant_type) {
-            method.GetCode()[i].oper = _AQVM_OPERATOR_DIVF;
-          }
-        } else {
-          DIV(memory_ptr, arguments.operand1, arguments.operand2,
-              arguments.operand3);
-        }
+        DIV(memory_ptr, operand1, operand2,
+            operand3);
+        QuickenArithmetic(memory_ptr, instruction, operand1, operand2,
+                          operand3, _AQVM_OPERATOR_QUICK_DIVI,
+                          _AQVM_OPERATOR_QUICK_DIVF);
         break;
       case _AQVM_OPERATOR_REM:
-        if (memory_ptr[arguments.operand1].type == 0x02 &&
-            memory_ptr[arguments.operand2].type == 0x02 &&
-            memory_ptr[arguments.operand3].type == 0x02) {
-          memory_ptr[arguments.operand1].data.int_data =
-              memory_ptr[arguments.operand2].data.int_data %
-              memory_ptr[arguments.operand3].data.int_data;
-          if (memory_ptr[arguments.operand1].constant_type &&
-              memory_ptr[arguments.operand2].constant_type &&
-              memory_ptr[arguments.operand3].constant_type) {
-            method.GetCode()[i].oper = _AQVM_OPERATOR_REMI;
-          }
-        } else {
-          REM(memory_ptr, arguments.operand1, arguments.operand2,
-              arguments.operand3);
-        }
+        REM(memory_ptr, operand1, operand2,
+            operand3);
+        QuickenArithmetic(memory_ptr, instruction, operand1, operand2,
+                          operand3, _AQVM_OPERATOR_QUICK_REMI,
+                          _AQVM_OPERATOR_NOP);
         break;
       case _AQVM_OPERATOR_NEG:
-        if (memory_ptr[arguments.operand2].type == 0x02) {
-          SetLong(memory_ptr + arguments.operand1,
-                  -memory_ptr[arguments.operand2].data.int_data);
-        } else if (memory_ptr[arguments.operand2].type == 0x03) {
-          SetDouble(memory_ptr + arguments.operand1,
-                    -memory_ptr[arguments.operand2].data.float_data);
+        if (memory_ptr[operand2].type == 0x02) {
+          SetLong(memory_ptr + operand1,
+                  -memory_ptr[operand2].data.int_data);
+        } else if (memory_ptr[operand2].type == 0x03) {
+          SetDouble(memory_ptr + operand1,
+                    -memory_ptr[operand2].data.float_data);
         } else {
-          NEG(memory_ptr, arguments.operand1, arguments.operand2);
+          NEG(memory_ptr, operand1, operand2);
         }
         break;
       case _AQVM_OPERATOR_SHL:
-        SHL(memory_ptr, arguments.operand1, arguments.operand2,
-            arguments.operand3);
+        SHL(memory_ptr, operand1, operand2,
+            operand3);
         break;
       case _AQVM_OPERATOR_SHR:
-        SHR(memory_ptr, arguments.operand1, arguments.operand2,
-            arguments.operand3);
+        SHR(memory_ptr, operand1, operand2,
+            operand3);
         break;
       case _AQVM_OPERATOR_REFER:
-        REFER(memory, arguments.operand1, arguments.operand2);
+        REFER(memory, operand1, operand2);
         break;
       case _AQVM_OPERATOR_IF:
-        i = IF(memory_ptr, arguments.operand1, arguments.operand2,
-               arguments.operand3);
+        i = IF(memory_ptr, operand1, operand2,
+               operand3);
         i--;
         break;
       case _AQVM_OPERATOR_AND:
-        AND(memory_ptr, arguments.operand1, arguments.operand2,
-            arguments.operand3);
+        AND(memory_ptr, operand1, operand2,
+            operand3);
         break;
       case _AQVM_OPERATOR_OR:
-        OR(memory_ptr, arguments.operand1, arguments.operand2,
-           arguments.operand3);
+        OR(memory_ptr, operand1, operand2,
+           operand3);
         break;
       case _AQVM_OPERATOR_XOR:
-        XOR(memory_ptr, arguments.operand1, arguments.operand2,
-            arguments.operand3);
+        XOR(memory_ptr, operand1, operand2,
+            operand3);
         break;
       case _AQVM_OPERATOR_CMP:
-        CMP(memory_ptr, arguments.operand1, arguments.operand2,
-            arguments.operand3, arguments.operand4);
+        CMP(memory_ptr, operand1, operand2,
+            operand3, operand4);
+        QuickenCompare(memory_ptr, instruction, operand1, operand3, operand4);
         break;
       case _AQVM_OPERATOR_EQUAL:
-        if (memory_ptr[arguments.operand2].type == 0x02) {
-          SetLong(memory_ptr + arguments.operand1,
-                  memory_ptr[arguments.operand2].data.int_data);
-        } else if (memory_ptr[arguments.operand2].type == 0x03) {
-          SetDouble(memory_ptr + arguments.operand1,
-                    memory_ptr[arguments.operand2].data.float_data);
+        if (memory_ptr[operand2].type == 0x02) {
+          SetLong(memory_ptr + operand1,
+                  memory_ptr[operand2].data.int_data);
+        } else if (memory_ptr[operand2].type == 0x03) {
+          SetDouble(memory_ptr + operand1,
+                    memory_ptr[operand2].data.float_data);
         } else {
-          EQUAL(memory_ptr, arguments.operand1, arguments.operand2);
+          EQUAL(memory_ptr, operand1, operand2);
         }
         break;
       case _AQVM_OPERATOR_GOTO:
-        i = GOTO(memory_ptr, arguments.operand1);
+        i = GOTO(instruction.operand1);
         i--;
+        CollectAtSafePoint();
         break;
       case _AQVM_OPERATOR_INVOKE_METHOD: {
-        auto origin_class_index = current_class_index;
-        current_class_index = arguments[0];
-        INVOKE_METHOD(memory, classes, builtin_functions,
-                      instructions_ptr[i].arguments);
-        current_class_index = origin_class_index;
+        CollectAtSafePoint();
+        auto call_arguments = GetOperands(&instruction, frame_base);
+        InlineCache& cache = method->GetInlineCache(i);
+        i += instruction.GetExtensionSize();
+        if (call_arguments.size() < 3) INTERNAL_ERROR("Invalid arguments.");
+
+        auto builtin_function = LookupCachedBuiltin(
+            memory_ptr, call_arguments[1], builtin_functions, cache);
+        if (builtin_function != nullptr) {
+          auto origin_class_index = current_class_index;
+          current_class_index = operand1;
+          call_arguments.erase(call_arguments.begin(), call_arguments.begin() + 2);
+          (*builtin_function)(memory, call_arguments);
+          current_class_index = origin_class_index;
+          memory_ptr = memory->GetMemory().data();
+          break;
+        }
+
+        // Enters the callee in this loop.
+        std::size_t callee_object = call_arguments[0];
+        std::size_t callee_name_object = call_arguments[1];
+        call_arguments.erase(call_arguments.begin(), call_arguments.begin() + 2);
+        std::size_t callee_frame_base = 0;
+        Function* callee =
+            EnterClassMethod(memory, callee_object, callee_name_object,
+                             call_arguments, classes, &cache,
+                             callee_frame_base);
+        if (callee == nullptr) break;
+
+        call_stack.push_back({method, i, frame_base, saved_current_class_index});
+        saved_current_class_index = current_class_index;
+        current_class_index = callee_object;
+        method = callee;
+        instructions_ptr = method->GetCode().data();
+        instructions_size = method->GetCode().size();
+        frame_base = callee_frame_base;
+        memory_ptr = memory->GetMemory().data();
+        i = -1;
         break;
       }
       case _AQVM_OPERATOR_LOAD_MEMBER:
-        if (arguments[1] == 0) {
-          LOAD_MEMBER(memory, classes, arguments.operand1, current_class_index,
-                      arguments[2]);
+        if (operand2 == 0) {
+          LOAD_MEMBER(memory, classes, operand1,
+                      current_class_index, operand3);
         } else {
-          LOAD_MEMBER(memory, classes, arguments.operand1, arguments.operand2,
-                      arguments[2]);
+          LOAD_MEMBER(memory, classes, operand1,
+                      operand2, operand3);
         }
         break;
 
       case _AQVM_OPERATOR_ADDI:
-        memory_ptr[arguments.operand1].data.int_data =
-            memory_ptr[arguments.operand2].data.int_data +
-            memory_ptr[arguments.operand3].data.int_data;
+        memory_ptr[operand1].data.int_data =
+            memory_ptr[operand2].data.int_data +
+            memory_ptr[operand3].data.int_data;
         break;
       case _AQVM_OPERATOR_SUBI:
-        memory_ptr[arguments.operand1].data.int_data =
-            memory_ptr[arguments.operand2].data.int_data -
-            memory_ptr[arguments.operand3].data.int_data;
+        memory_ptr[operand1].data.int_data =
+            memory_ptr[operand2].data.int_data -
+            memory_ptr[operand3].data.int_data;
         break;
       case _AQVM_OPERATOR_MULI:
-        memory_ptr[arguments.operand1].data.int_data =
-            memory_ptr[arguments.operand2].data.int_data *
-            memory_ptr[arguments.operand3].data.int_data;
+        memory_ptr[operand1].data.int_data =
+            memory_ptr[operand2].data.int_data *
+            memory_ptr[operand3].data.int_data;
         break;
       case _AQVM_OPERATOR_DIVI:
-        memory_ptr[arguments.operand1].data.int_data =
-            memory_ptr[arguments.operand2].data.int_data /
-            memory_ptr[arguments.operand3].data.int_data;
+        memory_ptr[operand1].data.int_data =
+            memory_ptr[operand2].data.int_data /
+            memory_ptr[operand3].data.int_data;
         break;
       case _AQVM_OPERATOR_REMI:
-        memory_ptr[arguments.operand1].data.int_data =
-            memory_ptr[arguments.operand2].data.int_data %
-            memory_ptr[arguments.operand3].data.int_data;
+        memory_ptr[operand1].data.int_data =
+            memory_ptr[operand2].data.int_data %
+            memory_ptr[operand3].data.int_data;
         break;
       case _AQVM_OPERATOR_ADDF:
-        memory_ptr[arguments.operand1].data.float_data =
-            memory_ptr[arguments.operand2].data.float_data +
-            memory_ptr[arguments.operand3].data.float_data;
+        memory_ptr[operand1].data.float_data =
+            memory_ptr[operand2].data.float_data +
+            memory_ptr[operand3].data.float_data;
         break;
       case _AQVM_OPERATOR_SUBF:
-        memory_ptr[arguments.operand1].data.float_data =
-            memory_ptr[arguments.operand2].data.float_data -
-            memory_ptr[arguments.operand3].data.float_data;
+        memory_ptr[operand1].data.float_data =
+            memory_ptr[operand2].data.float_data -
+            memory_ptr[operand3].data.float_data;
         break;
       case _AQVM_OPERATOR_MULF:
-        memory_ptr[arguments.operand1].data.float_data =
-            memory_ptr[arguments.operand2].data.float_data *
-            memory_ptr[arguments.operand3].data.float_data;
+        memory_ptr[operand1].data.float_data =
+            memory_ptr[operand2].data.float_data *
+            memory_ptr[operand3].data.float_data;
         break;
       case _AQVM_OPERATOR_DIVF:
-        memory_ptr[arguments.operand1].data.float_data =
-            memory_ptr[arguments.operand2].data.float_data /
-            memory_ptr[arguments.operand3].data.float_data;
+        memory_ptr[operand1].data.float_data =
+            memory_ptr[operand2].data.float_data /
+            memory_ptr[operand3].data.float_data;
+        break;
+      case _AQVM_OPERATOR_QUICK_ADDI:
+        if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x02)) {
+          memory_ptr[operand1].data.int_data =
+              memory_ptr[operand2].data.int_data +
+              memory_ptr[operand3].data.int_data;
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_ADD);
+        ADD(memory_ptr, operand1, operand2,
+            operand3);
+        break;
+      case _AQVM_OPERATOR_QUICK_ADDF:
+        if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x03)) {
+          memory_ptr[operand1].data.float_data =
+              memory_ptr[operand2].data.float_data +
+              memory_ptr[operand3].data.float_data;
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_ADD);
+        ADD(memory_ptr, operand1, operand2,
+            operand3);
+        break;
+      case _AQVM_OPERATOR_QUICK_SUBI:
+        if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x02)) {
+          memory_ptr[operand1].data.int_data =
+              memory_ptr[operand2].data.int_data -
+              memory_ptr[operand3].data.int_data;
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_SUB);
+        SUB(memory_ptr, operand1, operand2,
+            operand3);
+        break;
+      case _AQVM_OPERATOR_QUICK_SUBF:
+        if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x03)) {
+          memory_ptr[operand1].data.float_data =
+              memory_ptr[operand2].data.float_data -
+              memory_ptr[operand3].data.float_data;
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_SUB);
+        SUB(memory_ptr, operand1, operand2,
+            operand3);
+        break;
+      case _AQVM_OPERATOR_QUICK_MULI:
+        if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x02)) {
+          memory_ptr[operand1].data.int_data =
+              memory_ptr[operand2].data.int_data *
+              memory_ptr[operand3].data.int_data;
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_MUL);
+        MUL(memory_ptr, operand1, operand2,
+            operand3);
+        break;
+      case _AQVM_OPERATOR_QUICK_MULF:
+        if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x03)) {
+          memory_ptr[operand1].data.float_data =
+              memory_ptr[operand2].data.float_data *
+              memory_ptr[operand3].data.float_data;
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_MUL);
+        MUL(memory_ptr, operand1, operand2,
+            operand3);
+        break;
+      case _AQVM_OPERATOR_QUICK_DIVI:
+        if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x02)) {
+          memory_ptr[operand1].data.int_data =
+              memory_ptr[operand2].data.int_data /
+              memory_ptr[operand3].data.int_data;
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_DIV);
+        DIV(memory_ptr, operand1, operand2,
+            operand3);
+        break;
+      case _AQVM_OPERATOR_QUICK_DIVF:
+        if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x03)) {
+          memory_ptr[operand1].data.float_data =
+              memory_ptr[operand2].data.float_data /
+              memory_ptr[operand3].data.float_data;
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_DIV);
+        DIV(memory_ptr, operand1, operand2,
+            operand3);
+        break;
+      case _AQVM_OPERATOR_QUICK_REMI:
+        if (HasOperandTypes(memory_ptr, operand1, operand2, operand3, 0x02)) {
+          memory_ptr[operand1].data.int_data =
+              memory_ptr[operand2].data.int_data %
+              memory_ptr[operand3].data.int_data;
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_REM);
+        REM(memory_ptr, operand1, operand2,
+            operand3);
+        break;
+      case _AQVM_OPERATOR_QUICK_CMPI:
+        if (HasCompareTypes(memory_ptr, operand1, operand3, operand4, 0x02)) {
+          memory_ptr[operand1].data.byte_data = CompareValues(
+              operand2,
+              memory_ptr[operand3].data.int_data,
+              memory_ptr[operand4].data.int_data);
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_CMP);
+        CMP(memory_ptr, operand1, operand2,
+            operand3, operand4);
+        break;
+      case _AQVM_OPERATOR_QUICK_CMPF:
+        if (HasCompareTypes(memory_ptr, operand1, operand3, operand4, 0x03)) {
+          memory_ptr[operand1].data.byte_data = CompareValues(
+              operand2,
+              memory_ptr[operand3].data.float_data,
+              memory_ptr[operand4].data.float_data);
+          break;
+        }
+        Deoptimize(instruction, _AQVM_OPERATOR_CMP);
+        CMP(memory_ptr, operand1, operand2,
+            operand3, operand4);
+        break;
+      case _AQVM_OPERATOR_CMPI:
+        memory_ptr[operand1].data.byte_data =
+            CompareValues(operand2, memory_ptr[operand3].data.int_data,
+                          memory_ptr[operand4].data.int_data);
+        break;
+      case _AQVM_OPERATOR_CMPF:
+        memory_ptr[operand1].data.byte_data =
+            CompareValues(operand2, memory_ptr[operand3].data.float_data,
+                          memory_ptr[operand4].data.float_data);
+        break;
+      case _AQVM_OPERATOR_CMP_IF:
+      case _AQVM_OPERATOR_CMPI_IF:
+      case _AQVM_OPERATOR_CMPF_IF: {
+        // A backward branch is a safe point like GOTO, as it may close a loop.
+        int64_t target =
+            CompareAndBranch(memory_ptr, &instruction, frame_base);
+        if (target <= i) CollectAtSafePoint();
+        i = target;
+        i--;
+        break;
+      }
+      case _AQVM_OPERATOR_INC_CMP_IF: {
+        memory_ptr[operand1].data.int_data =
+            memory_ptr[operand2].data.int_data +
+            memory_ptr[operand3].data.int_data;
+        // The fused instruction replaces the back edge GOTO of its loop.
+        int64_t target = CompareAndBranch(
+            memory_ptr, instructions_ptr + instructions_ptr[i + 1].operand1,
+            frame_base);
+        if (target <= i) CollectAtSafePoint();
+        i = target;
+        i--;
+        break;
+      }
+      case _AQVM_OPERATOR_ADD_STORE:
+        StoreArithmetic(
+            memory_ptr, operand1, operand2, operand3,
+            ResolveOperand(instructions_ptr[i + 1].operand1, frame_base),
+            [](auto a, auto b) { return a + b; }, ADD);
+        i++;
+        break;
+      case _AQVM_OPERATOR_SUB_STORE:
+        StoreArithmetic(
+            memory_ptr, operand1, operand2, operand3,
+            ResolveOperand(instructions_ptr[i + 1].operand1, frame_base),
+            [](auto a, auto b) { return a - b; }, SUB);
+        i++;
+        break;
+      case _AQVM_OPERATOR_MUL_STORE:
+        StoreArithmetic(
+            memory_ptr, operand1, operand2, operand3,
+            ResolveOperand(instructions_ptr[i + 1].operand1, frame_base),
+            [](auto a, auto b) { return a * b; }, MUL);
+        i++;
+        break;
+      case _AQVM_OPERATOR_ADD_TO_LOCAL: {
+        const std::size_t local =
+            ResolveOperand(instructions_ptr[i + 1].operand1, frame_base);
+        if (memory_ptr[operand2].type == 0x02) {
+          SetLong(memory_ptr + operand1, memory_ptr[operand2].data.int_data);
+        } else {
+          EQUAL(memory_ptr, operand1, operand2);
+        }
+        memory_ptr[local].data.int_data =
+            memory_ptr[ResolveOperand(instructions_ptr[i + 1].operand2,
+                                      frame_base)]
+                .data.int_data +
+            memory_ptr[ResolveOperand(instructions_ptr[i + 1].operand3,
+                                      frame_base)]
+                .data.int_data;
+        i++;
+        break;
+      }
+      case _AQVM_OPERATOR_LOAD_ELEMENT:
+        LOAD_ELEMENT(memory_ptr, operand1, operand2, operand3, classes,
+                     builtin_functions);
+        break;
+      case _AQVM_OPERATOR_STORE_ELEMENT:
+        STORE_ELEMENT(
+            memory_ptr, operand1, operand2, operand3,
+            ResolveOperand(instructions_ptr[i + 1].operand2, frame_base),
+            classes, builtin_functions);
+        i++;
         break;
       case _AQVM_OPERATOR_LOAD_MODULE_MEMBER: {
         // operand1: result index in local memory
         // operand2: module pointer index in local memory
         // operand3: member name index in local memory
-        if (memory_ptr[arguments.operand2].type != 0x0A) {
+        if (memory_ptr[operand2].type != 0x0A) {
           LOGGING_ERROR("LOAD_MODULE_MEMBER: Module pointer expected at operand2");
           break;
         }
-        Interpreter* module_interp = static_cast<Interpreter*>(memory_ptr[arguments.operand2].data.pointer_data);
+        Interpreter* module_interp = static_cast<Interpreter*>(memory_ptr[operand2].data.pointer_data);
         if (module_interp == nullptr) {
           LOGGING_ERROR("LOAD_MODULE_MEMBER: Null module interpreter");
           break;
         }
         
-        std::string member_name = GetString(memory_ptr + arguments.operand3);
+        std::string member_name = GetString(memory_ptr + operand3);
         auto& module_vars = module_interp->context.variables;
         auto var_it = module_vars.find("#" + member_name);
         if (var_it == module_vars.end()) {
@@ -1866,23 +2632,24 @@ int InvokeClassMethod(
         }
         
         // Create reference to module variable
-        ObjectReference* ref = new ObjectReference();
+        ObjectReference* ref = Allocate<ObjectReference>();
         ref->is_class = false;
         ref->memory.memory = module_interp->global_memory;
         ref->index.index = var_it->second;
         
-        memory_ptr[arguments.operand1].type = 0x07;
-        memory_ptr[arguments.operand1].constant_type = false;
-        memory_ptr[arguments.operand1].data.reference_data = ref;
+        memory_ptr[operand1].type = 0x07;
+        memory_ptr[operand1].constant_type = false;
+        memory_ptr[operand1].data.reference_data = ref;
         break;
       }
       case _AQVM_OPERATOR_INVOKE_MODULE_METHOD: {
-        // Arguments in instruction.arguments vector:
+        // Operands of the instruction and its extension words:
         // [0]: module pointer index
         // [1]: method name index  
         // [2]: return value index
         // [3+]: method arguments
-        auto& args = instructions_ptr[i].arguments;
+        auto args = GetOperands(&instruction, frame_base);
+        i += instruction.GetExtensionSize();
         if (args.size() < 3) {
           LOGGING_ERROR("INVOKE_MODULE_METHOD: Insufficient arguments");
           break;
@@ -1902,7 +2669,6 @@ int InvokeClassMethod(
         
         // Create references in module memory for all arguments
         auto module_memory = module_interp->global_memory;
-        auto module_ptr = module_memory->GetMemory().data();
         
         std::vector<std::size_t> module_args;
         // Return value reference
@@ -1915,18 +2681,28 @@ int InvokeClassMethod(
           module_args.push_back(arg_ref_idx);
         }
         
+        // Adding the references may have moved the module memory.
+        auto module_ptr = module_memory->GetMemory().data();
+        
         // Check if it's a lambda (variable holding function name)
         auto& module_vars = module_interp->context.variables;
         auto var_it = module_vars.find("#" + method_name);
         if (var_it != module_vars.end() && module_ptr[var_it->second].type == 0x05) {
           // It's a lambda stored as a variable - get the actual function name
-          method_name = *module_ptr[var_it->second].data.string_data;
+          method_name = module_ptr[var_it->second].data.string_data->Get();
         }
         
         // Invoke in module interpreter's context
         std::size_t method_name_idx = module_memory->AddString(method_name);
         InvokeClassMethod(module_memory, 2, method_name_idx, module_args,
                          module_interp->classes, module_interp->builtin_functions);
+
+        // The slots of the call are reused by the next call, so calling into a
+        // module doesn't grow its memory.
+        module_memory->Release(method_name_idx);
+        for (auto it = module_args.rbegin(); it != module_args.rend(); ++it)
+          module_memory->Release(*it);
+        memory_ptr = memory->GetMemory().data();
         break;
       }
       case _AQVM_OPERATOR_NEW_MODULE: {
@@ -1936,15 +2712,15 @@ int InvokeClassMethod(
         // operand3: class name index (string)
         // operand4: module interpreter pointer index
         
-        if (arguments.size() < 4) {
+        if (instruction.size < 4) {
           LOGGING_ERROR("NEW_MODULE: Insufficient arguments");
           break;
         }
         
-        std::size_t result_idx = arguments.operand1;
-        std::size_t size_idx = arguments.operand2;
-        std::size_t type_idx = arguments.operand3;
-        std::size_t module_ptr_idx = arguments[3];
+        std::size_t result_idx = operand1;
+        std::size_t size_idx = operand2;
+        std::size_t type_idx = operand3;
+        std::size_t module_ptr_idx = operand4;
         
         // Get the module interpreter pointer
         if (memory_ptr[module_ptr_idx].type != 0x0A) {
@@ -1966,6 +2742,7 @@ int InvokeClassMethod(
         if (result != 0) {
           LOGGING_ERROR("NEW_MODULE: Failed to create module class instance");
         }
+        memory_ptr = memory->GetMemory().data();
         break;
       }
       case _AQVM_OPERATOR_WIDE:
@@ -1977,21 +2754,19 @@ int InvokeClassMethod(
 #endif
   }
 
-  // Restore the previous current_class_index
-  current_class_index = saved_current_class_index;
-
+  dispatch_depth--;
   return 0;
 }
-Function SelectBestFunction(Object* memory, std::vector<Function>& functions,
-                            std::vector<std::size_t>& arguments) {
+Function* SelectBestFunction(Object* memory, std::vector<Function>& functions,
+                             std::vector<std::size_t>& arguments) {
   int64_t value = -1;
-  Function best_function;
+  Function* best_function = nullptr;
   bool has_same_value_function = false;
   for (auto& function : functions) {
     int64_t function_value =
         GetFunctionOverloadValue(memory, function, arguments);
     if (function_value > value) {
-      best_function = function;
+      best_function = &function;
       value = function_value;
       has_same_value_function = false;
     } else if (function_value == value) {
@@ -2025,7 +2800,13 @@ int64_t GetFunctionOverloadValue(Object* memory, Function& function,
 
   for (std::size_t i = 1; i < function.GetParameters().size(); i++) {
     Object* argument = GetOrigin(memory + arguments[i]);
-    Object* function_param = GetOrigin(memory + function.GetParameters()[i]);
+
+    // Parameters living in the activation frame are read from its template.
+    std::size_t parameter = function.GetParameters()[i];
+    Object* function_param =
+        IsFrameOperand(parameter)
+            ? &function.GetFrame()[ResolveOperand(parameter, 0)]
+            : GetOrigin(memory + parameter);
 
     bool is_number = argument->type >= 0x01 && argument->type <= 0x04 &&
                      function_param->type >= 0x01 &&
@@ -2044,11 +2825,12 @@ int64_t GetFunctionOverloadValue(Object* memory, Function& function,
     if (function_param->constant_type) {
       if (function_param->type == argument->type) {
         // Array type.
-        if (function_param->type == 0x09) {
-          if (*argument->data.class_data->GetMembers()["@name"]
-                   .data.string_data !=
-              *function_param->data.class_data->GetMembers()["@name"]
-                   .data.string_data)
+        if (function_param->type == 0x09 &&
+            function_param->data.class_data != nullptr) {
+          if (argument->data.class_data->GetMember(kClassNameSymbol)
+                  .data.string_data->Get() !=
+              function_param->data.class_data->GetMember(kClassNameSymbol)
+                  .data.string_data->Get())
             return -1;
         }
 
@@ -2080,15 +2862,28 @@ int LOAD_MEMBER(Memory* memory, std::unordered_map<std::string, Class>& classes,
   if (class_object.type != 0x09)
     LOGGING_ERROR("class_index is not a class object.");
 
-  auto& member_name_object = memory->GetMemory()[operand];
-  if (member_name_object.type != 0x05)
-    LOGGING_ERROR("operand is not a string.");
+  // The member name is interned at code generation and passed as an
+  // immediate. A string operand is interned here.
+  Symbol member_name = 0;
+  if (IsImmediateOperand(operand)) {
+    member_name = GetImmediate(operand);
+  } else {
+    auto& member_name_object = memory->GetMemory()[operand];
+    if (member_name_object.type != 0x05)
+      LOGGING_ERROR("operand is not a string.");
+    member_name = InternSymbol(member_name_object.data.string_data->Get());
+  }
 
-  ObjectReference* reference = new ObjectReference();
+  // The result is usually the reference this instruction left on its
+  // previous run. It is pointed at the member in place so that member
+  // accesses in loops don't allocate.
+  ObjectReference* reference = result_reference.type == 0x07
+                                   ? result_reference.data.reference_data
+                                   : Allocate<ObjectReference>();
   reference->is_class = true;
   reference->memory.class_memory = class_object.data.class_data;
-  reference->index.variable_name =
-      new std::string(*member_name_object.data.string_data);
+  reference->index.slot =
+      class_object.data.class_data->GetMemberSlot(member_name);
 
   result_reference.type = 0x07;
   result_reference.constant_type = true;
@@ -2109,7 +2904,7 @@ int LOAD_MODULE_MEMBER(Memory* local_memory, Memory* module_memory,
   auto& result_object = local_memory->GetMemory()[result];
   
   // Create a reference to the module's variable
-  ObjectReference* reference = new ObjectReference();
+  ObjectReference* reference = Allocate<ObjectReference>();
   reference->is_class = false;
   reference->memory.memory = module_memory;
   reference->index.index = module_var_index;
@@ -2157,7 +2952,10 @@ int INVOKE_MODULE_METHOD(
       std::size_t ref_index = module_memory->AddReference(local_memory, arg);
       module_args.push_back(ref_index);
     }
-    return builtin_it->second(module_memory, module_args);
+    int result = builtin_it->second(module_memory, module_args);
+    for (auto it = module_args.rbegin(); it != module_args.rend(); ++it)
+      module_memory->Release(*it);
+    return result;
   }
 
   // For class methods, invoke using the module's classes and memory
@@ -2189,7 +2987,7 @@ int NEW_MODULE(Memory* local_memory, Memory* module_memory,
     return -1;
   }
 
-  std::string class_name = *type_data.data.string_data;
+  std::string class_name = type_data.data.string_data->Get();
   
   // Classes in modules are stored with a leading dot (e.g., ".test_class")
   // Prepend a dot if not already present
@@ -2198,14 +2996,16 @@ int NEW_MODULE(Memory* local_memory, Memory* module_memory,
   }
   
   // Get the size value
-  std::size_t size_value = GetUint64(local_ptr + size);
+  std::size_t size_value = IsImmediateOperand(size)
+                               ? GetImmediate(size)
+                               : GetUint64(local_ptr + size);
 
   // Create the object in module memory
   std::size_t module_obj_index = module_memory->Add(1);
   
   // Use the module's NEW operator to create the instance
   std::size_t module_type_index = module_memory->AddString(class_name);
-  std::size_t module_size_index = module_memory->AddUint64t(size_value);
+  std::size_t module_size_index = MakeImmediate(size_value);
   
   int result_code = NEW(module_memory->GetMemory().data(), module_classes,
                        module_obj_index, module_size_index, module_type_index,
@@ -2221,9 +3021,12 @@ int NEW_MODULE(Memory* local_memory, Memory* module_memory,
   std::vector<std::size_t> constructor_args = {return_val_idx};
   InvokeClassMethod(module_memory, module_obj_index, constructor_name_idx,
                    constructor_args, module_classes, module_builtin_functions);
+  module_memory->Release(return_val_idx);
+  module_memory->Release(constructor_name_idx);
+  module_memory->Release(module_type_index);
 
   // Create a reference in local memory to the module object
-  ObjectReference* reference = new ObjectReference();
+  ObjectReference* reference = Allocate<ObjectReference>();
   reference->is_class = false;
   reference->memory.memory = module_memory;
   reference->index.index = module_obj_index;
@@ -51,10 +51,72 @@
 #define _AQVM_OPERATOR_LOAD_MODULE_MEMBER 0x25
 #define _AQVM_OPERATOR_INVOKE_MODULE_METHOD 0x26
 #define _AQVM_OPERATOR_NEW_MODULE 0x27
+
+// Quickened operators. The interpreter rewrites generic arithmetic and
+// comparison instructions into these forms after they ran on operands of a
+// stable type. Each form checks the operand types first and falls back to the
+// generic operator if they changed. They are never emitted by the generator.
+#define _AQVM_OPERATOR_QUICK_ADDI 0x28
+#define _AQVM_OPERATOR_QUICK_ADDF 0x29
+#define _AQVM_OPERATOR_QUICK_SUBI 0x2A
+#define _AQVM_OPERATOR_QUICK_SUBF 0x2B
+#define _AQVM_OPERATOR_QUICK_MULI 0x2C
+#define _AQVM_OPERATOR_QUICK_MULF 0x2D
+#define _AQVM_OPERATOR_QUICK_DIVI 0x2E
+#define _AQVM_OPERATOR_QUICK_DIVF 0x2F
+#define _AQVM_OPERATOR_QUICK_REMI 0x30
+#define _AQVM_OPERATOR_QUICK_CMPI 0x31
+#define _AQVM_OPERATOR_QUICK_CMPF 0x32
+
+// Superinstructions. FuseSuperinstructions() rewrites the operator of the
+// first instruction of a common pair into one of these forms after code
+// generation. The second instruction is left in place so that jumps to it
+// still work, and the fused form runs both and skips it.
+//   CMP_IF:       CMP t, op, a, b; IF t, true, false
+//   INC_CMP_IF:   ADDI x, x, k; GOTO l, where l starts a CMP_IF pair
+//   ADD_STORE:    ADD t, a, b; EQUAL x, t, also with ADDI or ADDF
+//   SUB_STORE and MUL_STORE are the same for SUB and MUL.
+//   ADD_TO_LOCAL: EQUAL t, x; ADDI x, x, k
+#define _AQVM_OPERATOR_CMP_IF 0x33
+#define _AQVM_OPERATOR_INC_CMP_IF 0x34
+#define _AQVM_OPERATOR_ADD_STORE 0x35
+#define _AQVM_OPERATOR_SUB_STORE 0x36
+#define _AQVM_OPERATOR_MUL_STORE 0x37
+#define _AQVM_OPERATOR_ADD_TO_LOCAL 0x38
+
+// Element access. SpecializeElementAccess() rewrites an ARRAY whose result is
+// only read by the next instruction into LOAD_ELEMENT, and an ARRAY whose
+// result is only assigned by the next EQUAL into STORE_ELEMENT, which runs the
+// pair. On packed arrays they copy the element instead of making a reference
+// to it; on other arrays they run like ARRAY.
+//   LOAD_ELEMENT:  ARRAY t, a, i; <instruction reading t>
+//   STORE_ELEMENT: ARRAY t, a, i; EQUAL t, v
+#define _AQVM_OPERATOR_LOAD_ELEMENT 0x39
+#define _AQVM_OPERATOR_STORE_ELEMENT 0x3A
+
+// Typed comparisons. The optimizer rewrites a CMP into CMPI or CMPF when it
+// proves both operands hold ints or floats and the result slot holds a byte.
+// Like ADDI, they check no types at run time. FuseSuperinstructions() fuses
+// them with the IF that tests their result like CMP and CMP_IF.
+//   CMPI_IF: CMPI t, op, a, b; IF t, true, false
+//   CMPF_IF: CMPF t, op, a, b; IF t, true, false
+#define _AQVM_OPERATOR_CMPI 0x3B
+#define _AQVM_OPERATOR_CMPF 0x3C
+#define _AQVM_OPERATOR_CMPI_IF 0x3D
+#define _AQVM_OPERATOR_CMPF_IF 0x3E
 #define _AQVM_OPERATOR_WIDE 0xFF
 
 namespace Aq {
 namespace Interpreter {
+extern std::size_t quickened_instruction_count;
+extern std::size_t deoptimized_instruction_count;
+extern std::size_t fused_instruction_count;
+extern std::size_t specialized_element_access_count;
+extern std::size_t invoked_method_count;
+extern std::size_t max_call_depth;
+extern std::size_t inline_cache_hit_count;
+extern std::size_t inline_cache_miss_count;
+
 int NOP();
 
 int NEW(Object* memory, std::unordered_map<std::string, Class>& classes,
@@ -66,6 +128,20 @@ int NEW(Object* memory, std::unordered_map<std::string, Class>& classes,
 int ARRAY(Object* memory, std::size_t result, std::size_t ptr,
           std::size_t index, std::unordered_map<std::string, Class>& classes);
 
+int LOAD_ELEMENT(
+    Object* memory, std::size_t result, std::size_t ptr, std::size_t index,
+    std::unordered_map<std::string, Class>& classes,
+    std::unordered_map<std::string,
+                       std::function<int(Memory*, std::vector<std::size_t>)>>&
+        builtin_functions);
+
+int STORE_ELEMENT(
+    Object* memory, std::size_t result, std::size_t ptr, std::size_t index,
+    std::size_t value, std::unordered_map<std::string, Class>& classes,
+    std::unordered_map<std::string,
+                       std::function<int(Memory*, std::vector<std::size_t>)>>&
+        builtin_functions);
+
 int ADD(Object* memory, std::size_t result, std::size_t operand1,
         std::size_t operand2);
 
@@ -107,7 +183,7 @@ int CMP(Object* memory, std::size_t result, std::size_t opcode,
 
 int EQUAL(Object* memory, std::size_t result, std::size_t value);
 
-size_t GOTO(Object* memory, std::size_t location);
+size_t GOTO(std::size_t location);
 
 int INVOKE_METHOD(
     Memory* memory, std::unordered_map<std::string, Class>& classes,
@@ -123,8 +199,8 @@ int InvokeClassMethod(
     std::unordered_map<std::string,
                        std::function<int(Memory*, std::vector<std::size_t>)>>&
         builtin_functions);
-Function SelectBestFunction(Object* memory, std::vector<Function>& functions,
-                            std::vector<std::size_t>& arguments);
+Function* SelectBestFunction(Object* memory, std::vector<Function>& functions,
+                             std::vector<std::size_t>& arguments);
 int64_t GetFunctionOverloadValue(Object* memory, Function& function,
                                  std::vector<std::size_t>& arguments);
 
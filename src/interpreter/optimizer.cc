@@ -0,0 +1,1622 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#include "interpreter/optimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "interpreter/function.h"
+#include "interpreter/memory.h"
+#include "interpreter/operator.h"
+
+namespace Aq {
+namespace Interpreter {
+// The most times the passes run over one function. Each round can expose more
+// work to the next, but real code settles after two or three.
+constexpr std::size_t kMaxOptimizationRounds = 4;
+
+// The size, in words, past which a function stops inlining calls, so that
+// calls of many small functions don't make it grow without bound.
+constexpr std::size_t kMaxInliningCallerSize = 4096;
+
+int optimization_level = 1;
+std::size_t inline_limit = 32;
+OptimizerStats optimizer_stats;
+
+void SetOptimizationLevel(int level) { optimization_level = level; }
+
+int GetOptimizationLevel() { return optimization_level; }
+
+void SetInlineLimit(std::size_t limit) { inline_limit = limit; }
+
+std::size_t GetInlineLimit() { return inline_limit; }
+
+std::size_t AddIntLiteral(Interpreter& interpreter, int64_t value) {
+  std::size_t index = interpreter.global_memory->AddLong(value);
+  interpreter.literals.insert(index);
+  return index;
+}
+
+std::size_t AddFloatLiteral(Interpreter& interpreter, double value) {
+  std::size_t index = interpreter.global_memory->AddDouble(value);
+  interpreter.literals.insert(index);
+  return index;
+}
+
+// Gets the operand |n| of the instruction at |code|. Operands past the fourth
+// are in the extension words.
+uint32_t& GetOperand(Bytecode* code, std::size_t n) {
+  Bytecode& word = code[n / 4];
+  switch (n % 4) {
+    case 0:
+      return word.operand1;
+    case 1:
+      return word.operand2;
+    case 2:
+      return word.operand3;
+    default:
+      return word.operand4;
+  }
+}
+
+// Returns true if |instruction| stores into the slot of its first operand and
+// only reads the slots of the others.
+bool IsStore(const Bytecode& instruction) {
+  if (instruction.size == 0 || instruction.size > 4) return false;
+  switch (instruction.oper) {
+    case _AQVM_OPERATOR_ADD:
+    case _AQVM_OPERATOR_SUB:
+    case _AQVM_OPERATOR_MUL:
+    case _AQVM_OPERATOR_DIV:
+    case _AQVM_OPERATOR_REM:
+    case _AQVM_OPERATOR_NEG:
+    case _AQVM_OPERATOR_SHL:
+    case _AQVM_OPERATOR_SHR:
+    case _AQVM_OPERATOR_AND:
+    case _AQVM_OPERATOR_OR:
+    case _AQVM_OPERATOR_XOR:
+    case _AQVM_OPERATOR_CMP:
+    case _AQVM_OPERATOR_CMPI:
+    case _AQVM_OPERATOR_CMPF:
+    case _AQVM_OPERATOR_EQUAL:
+    case _AQVM_OPERATOR_ADDI:
+    case _AQVM_OPERATOR_SUBI:
+    case _AQVM_OPERATOR_MULI:
+    case _AQVM_OPERATOR_DIVI:
+    case _AQVM_OPERATOR_REMI:
+    case _AQVM_OPERATOR_ADDF:
+    case _AQVM_OPERATOR_SUBF:
+    case _AQVM_OPERATOR_MULF:
+    case _AQVM_OPERATOR_DIVF:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if |instruction| is a CMP or one of its typed forms.
+bool IsCompare(const Bytecode& instruction) {
+  return instruction.oper == _AQVM_OPERATOR_CMP ||
+         instruction.oper == _AQVM_OPERATOR_CMPI ||
+         instruction.oper == _AQVM_OPERATOR_CMPF;
+}
+
+// Returns true if the optimizer knows every operand of |instruction|: stores,
+// jumps and NOPs.
+bool IsKnownInstruction(const Bytecode& instruction) {
+  return IsStore(instruction) || instruction.oper == _AQVM_OPERATOR_IF ||
+         instruction.oper == _AQVM_OPERATOR_GOTO ||
+         instruction.oper == _AQVM_OPERATOR_NOP;
+}
+
+// Returns true if the operand |n| of the known |instruction| is a slot it
+// reads. The operator of CMP and the targets of jumps aren't slots.
+bool IsReadOperand(const Bytecode& instruction, std::size_t n) {
+  switch (instruction.oper) {
+    case _AQVM_OPERATOR_NOP:
+    case _AQVM_OPERATOR_GOTO:
+      return false;
+    case _AQVM_OPERATOR_IF:
+      return n == 0;
+    case _AQVM_OPERATOR_CMP:
+    case _AQVM_OPERATOR_CMPI:
+    case _AQVM_OPERATOR_CMPF:
+      return n >= 2 && n < instruction.size;
+    default:
+      return n >= 1 && n < instruction.size;
+  }
+}
+
+// The classes of frame slots that may share a slot with others of the same
+// class, and kFixed for the slots that keep their own.
+enum class SlotClass { kFixed, kInt, kFloat, kByte, kCompareResult };
+
+// The types InferTypes() tells apart. kUnset is for slots at instructions no
+// path reached yet, kUninitialized for untyped slots nothing stored into yet
+// and kUnknown for slots that may hold values of different or other types.
+enum class InferredType : uint8_t {
+  kUnset,
+  kUninitialized,
+  kByte,
+  kInt,
+  kFloat,
+  kUnknown
+};
+
+// Gets the type of a slot that may hold values of type |a| or |b|.
+InferredType JoinInferredTypes(InferredType a, InferredType b) {
+  if (a == InferredType::kUnset || a == b) return b;
+  if (b == InferredType::kUnset) return a;
+  return InferredType::kUnknown;
+}
+
+// Gets the type of the value |object| holds.
+InferredType GetInferredType(const Object& object) {
+  switch (object.type) {
+    case 0x01:
+      return InferredType::kByte;
+    case 0x02:
+      return InferredType::kInt;
+    case 0x03:
+      return InferredType::kFloat;
+    default:
+      return InferredType::kUnknown;
+  }
+}
+
+// Returns true if |type| is a byte, an int or a float.
+bool IsNumberType(InferredType type) {
+  return type == InferredType::kByte || type == InferredType::kInt ||
+         type == InferredType::kFloat;
+}
+
+// Returns true if a path through |code| may read a slot of the frame before
+// anything writes it, which a copy of the code in a loop would see holding
+// the value of the last iteration. The |parameters_index| are written on
+// entry. The result of a call counts as written by the call.
+bool MayReadUnwrittenSlots(std::vector<Bytecode>& code,
+                           const std::vector<std::size_t>& parameters_index) {
+  if (code.empty()) return false;
+  std::unordered_set<std::size_t> entry_slots(parameters_index.begin(),
+                                              parameters_index.end());
+
+  // The slots written on every path to each instruction. Unset for the
+  // instructions no path reached yet.
+  std::vector<std::unordered_set<std::size_t>> written(code.size());
+  std::vector<bool> is_reached(code.size(), false);
+  written[0] = entry_slots;
+  is_reached[0] = true;
+  std::vector<std::size_t> pending = {0};
+  while (!pending.empty()) {
+    std::size_t i = pending.back();
+    pending.pop_back();
+    Bytecode& instruction = code[i];
+    bool is_call = instruction.oper == _AQVM_OPERATOR_INVOKE_METHOD;
+    std::unordered_set<std::size_t> state = written[i];
+    for (std::size_t n = 0; n < instruction.size; n++) {
+      std::size_t operand = GetOperand(&code[i], n);
+      bool is_read = is_call ? n != 2 : IsReadOperand(instruction, n);
+      if (is_read && IsFrameOperand(operand) && state.count(operand) == 0)
+        return true;
+    }
+    if (is_call) state.insert(GetOperand(&code[i], 2));
+    if (IsStore(instruction)) state.insert(instruction.operand1);
+
+    std::vector<std::size_t> successors = {i + 1 +
+                                           instruction.GetExtensionSize()};
+    if (instruction.oper == _AQVM_OPERATOR_GOTO)
+      successors = {instruction.operand1};
+    if (instruction.oper == _AQVM_OPERATOR_IF)
+      successors = {instruction.operand2, instruction.operand3};
+    for (std::size_t successor : successors) {
+      if (successor >= code.size()) continue;
+      if (!is_reached[successor]) {
+        is_reached[successor] = true;
+        written[successor] = state;
+        pending.push_back(successor);
+        continue;
+      }
+      std::size_t size = written[successor].size();
+      for (auto slot = written[successor].begin();
+           slot != written[successor].end();) {
+        if (state.count(*slot) == 0) {
+          slot = written[successor].erase(slot);
+        } else {
+          slot++;
+        }
+      }
+      if (written[successor].size() != size) pending.push_back(successor);
+    }
+  }
+  return false;
+}
+
+// Runs the passes over the code of one function. The passes on slots only
+// change how the function uses tracked slots: int and float locals and
+// temporaries in the frame that aren't parameters and only appear as operands
+// of stores and jumps. Nothing but the instructions of the function can read
+// or write such a slot, since no reference to it is ever made. Functions
+// without a frame have no tracked slots, so only the passes on the control
+// flow change them.
+class BytecodeOptimizer {
+ public:
+  BytecodeOptimizer(Interpreter& interpreter, std::vector<Object>* frame,
+                    std::vector<std::size_t>& parameters_index,
+                    std::vector<Bytecode>& code)
+      : interpreter_(interpreter),
+        frame_(frame),
+        parameters_index_(parameters_index),
+        code_(code) {}
+
+  void Run() {
+    if (!HasValidJumps()) return;
+
+    FindTrackedSlots();
+    if (InferTypes()) FindTrackedSlots();
+    if (InlineCalls()) {
+      FindTrackedSlots();
+      if (InferTypes()) FindTrackedSlots();
+    }
+    for (std::size_t round = 0; round < kMaxOptimizationRounds; round++) {
+      bool changed = CoalesceCopies();
+      changed |= PropagateValues();
+      changed |= RemoveDeadStores();
+      changed |= RemoveUnreachableCode();
+      if (!changed) break;
+    }
+
+    ThreadJumps();
+    RemoveUnreachableCode();
+    RemoveNopsAndJumpsToNext();
+    PackFrameSlots();
+    optimizer_stats.optimized_function_count++;
+  }
+
+  // Gets the vm type of the value the function returns on every path, or
+  // 0x00 if it may return values of different types or none.
+  uint8_t GetReturnType() const { return return_type_; }
+
+
+ private:
+  // Returns true if every jump lands on an instruction or at the end of the
+  // code.
+  bool HasValidJumps() {
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      const Bytecode& instruction = code_[i];
+      if (instruction.oper == _AQVM_OPERATOR_GOTO &&
+          (instruction.size != 1 || instruction.operand1 > code_.size()))
+        return false;
+      if (instruction.oper == _AQVM_OPERATOR_IF &&
+          (instruction.size != 3 || instruction.operand2 > code_.size() ||
+           instruction.operand3 > code_.size()))
+        return false;
+    }
+    return true;
+  }
+
+  void FindTrackedSlots() {
+    if (frame_ != nullptr) {
+      std::vector<Object>& frame = *frame_;
+      tracked_.assign(frame.size(), false);
+      for (std::size_t i = 0; i < frame.size(); i++)
+        tracked_[i] = frame[i].constant_type &&
+                      (frame[i].type == 0x02 || frame[i].type == 0x03);
+      for (std::size_t parameter : parameters_index_)
+        if (IsFrameOperand(parameter))
+          tracked_[parameter & ~kFrameOperandFlag] = false;
+      typed_locals_ = tracked_;
+    }
+
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      Bytecode& instruction = code_[i];
+      if (IsStore(instruction)) {
+        if (!IsFrameOperand(instruction.operand1))
+          written_globals_.insert(instruction.operand1);
+        continue;
+      }
+      if (IsKnownInstruction(instruction)) continue;
+
+      // Calls bind, and REFER, ARRAY and the member loads make references to,
+      // the slots of their operands.
+      for (std::size_t n = 0; n < instruction.size; n++) {
+        std::size_t operand = GetOperand(&code_[i], n);
+        if (!IsFrameOperand(operand)) {
+          written_globals_.insert(operand);
+        } else if ((operand & ~kFrameOperandFlag) < tracked_.size()) {
+          tracked_[operand & ~kFrameOperandFlag] = false;
+        }
+      }
+    }
+  }
+
+  bool IsTracked(std::size_t operand) const {
+    return IsFrameOperand(operand) &&
+           (operand & ~kFrameOperandFlag) < tracked_.size() &&
+           tracked_[operand & ~kFrameOperandFlag];
+  }
+
+  // Returns true if |operand| is an int or float local or temporary in the
+  // frame. Such a slot always holds a value of its type, even when
+  // references to it are made.
+  bool IsTypedLocal(std::size_t operand) const {
+    return IsFrameOperand(operand) &&
+           (operand & ~kFrameOperandFlag) < typed_locals_.size() &&
+           typed_locals_[operand & ~kFrameOperandFlag];
+  }
+
+  // Returns true if |operand| is a literal the function never writes.
+  bool IsLiteral(std::size_t operand) const {
+    return !IsFrameOperand(operand) && !IsImmediateOperand(operand) &&
+           interpreter_.literals.count(operand) != 0 &&
+           written_globals_.count(operand) == 0;
+  }
+
+  // Gets the compile-time object of a tracked slot or a literal. Folding adds
+  // literals, so the reference is only valid until the next fold.
+  Object& GetSlotObject(std::size_t operand) {
+    if (IsFrameOperand(operand))
+      return (*frame_)[operand & ~kFrameOperandFlag];
+    return interpreter_.global_memory->GetMemory()[operand];
+  }
+
+  std::unordered_set<std::size_t> GetJumpTargets() const {
+    std::unordered_set<std::size_t> targets;
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      if (code_[i].oper == _AQVM_OPERATOR_GOTO) {
+        targets.insert(code_[i].operand1);
+      } else if (code_[i].oper == _AQVM_OPERATOR_IF) {
+        targets.insert(code_[i].operand2);
+        targets.insert(code_[i].operand3);
+      }
+    }
+    return targets;
+  }
+
+  // Gets the positions the instruction at |i| may go to next. The end of the
+  // code is at code_.size().
+  std::vector<std::size_t> GetSuccessors(std::size_t i) const {
+    const Bytecode& instruction = code_[i];
+    if (instruction.oper == _AQVM_OPERATOR_GOTO) return {instruction.operand1};
+    if (instruction.oper == _AQVM_OPERATOR_IF)
+      return {instruction.operand2, instruction.operand3};
+    return {i + 1 + instruction.GetExtensionSize()};
+  }
+
+  // Gets the type the slot |operand| always holds: an int, float or byte
+  // slot whose type is constant, such as a typed local, a parameter or a
+  // literal. Other slots may hold anything.
+  InferredType GetStaticType(std::size_t operand) const {
+    if (IsImmediateOperand(operand)) return InferredType::kUnknown;
+    if (IsFrameOperand(operand)) {
+      std::size_t index = operand & ~kFrameOperandFlag;
+      if (frame_ == nullptr || index >= frame_->size() ||
+          !(*frame_)[index].constant_type)
+        return InferredType::kUnknown;
+      return GetInferredType((*frame_)[index]);
+    }
+
+    std::vector<Object>& memory = interpreter_.global_memory->GetMemory();
+    if (operand >= memory.size() || !memory[operand].constant_type)
+      return InferredType::kUnknown;
+    return GetInferredType(memory[operand]);
+  }
+
+  // Gets the type of |operand| at an instruction where the inferred slots
+  // have |types|.
+  InferredType GetTypeAt(const std::vector<InferredType>& types,
+                         std::size_t operand) const {
+    auto number = inferred_numbers_.find(operand);
+    if (number != inferred_numbers_.end()) return types[number->second];
+    return GetStaticType(operand);
+  }
+
+  // Gets the full name of the function the call |instruction| calls by name,
+  // and the number of its overloads in |overload_count|, once every overload
+  // declared was generated. Returns an empty name for calls of methods and
+  // builtins, calls through variables and calls of functions that aren't
+  // generated yet.
+  std::string GetCalledFunction(Bytecode* instruction,
+                                std::size_t& overload_count) {
+    std::size_t name = GetOperand(instruction, 1);
+    if (instruction->operand1 != 2 || IsFrameOperand(name) ||
+        IsImmediateOperand(name))
+      return "";
+    Object& name_object = GetSlotObject(name);
+    if (name_object.type != 0x05 || !name_object.constant_type) return "";
+
+    std::string function_name = GetString(&name_object);
+    auto overloads = interpreter_.functions.find(function_name);
+    if (overloads == interpreter_.functions.end() ||
+        interpreter_.builtin_functions.count(function_name) != 0)
+      return "";
+
+    // Declarations leave an unnamed placeholder in the list of overloads.
+    std::size_t declared_count = 0;
+    for (Function& overload : overloads->second)
+      if (overload.GetName().empty()) declared_count++;
+    if (declared_count == 0 ||
+        declared_count * 2 != overloads->second.size())
+      return "";
+    overload_count = declared_count;
+    return function_name;
+  }
+
+  // Returns true if the call |instruction| calls a function by name whose
+  // overloads all copy their arguments into parameters in their frames, so
+  // that the call only reads the slots of its arguments. Reference
+  // parameters may store into them.
+  bool BindsArgumentsByValue(Bytecode* instruction) {
+    if (instruction->oper != _AQVM_OPERATOR_INVOKE_METHOD ||
+        instruction->size < 3)
+      return false;
+    std::size_t overload_count = 0;
+    std::string function_name = GetCalledFunction(instruction, overload_count);
+    if (function_name.empty()) return false;
+
+    for (Function& overload : interpreter_.functions[function_name]) {
+      if (overload.GetName().empty()) continue;
+      if (overload.IsVariadic()) return false;
+      std::vector<std::size_t>& parameters = overload.GetParameters();
+      for (std::size_t n = 1; n < parameters.size(); n++) {
+        std::size_t index = parameters[n] & ~kFrameOperandFlag;
+        if (!IsFrameOperand(parameters[n]) ||
+            index >= overload.GetFrame().size() ||
+            overload.GetFrame()[index].type == 0x07)
+          return false;
+      }
+    }
+    return true;
+  }
+
+  // Gets the type of the value the call |instruction| stores into its result.
+  // Only calls of functions by name are known, once all of their overloads
+  // return values of the same type.
+  InferredType GetCallType(Bytecode* instruction) {
+    std::size_t overload_count = 0;
+    std::string function_name = GetCalledFunction(instruction, overload_count);
+    auto return_type = interpreter_.return_types.find(function_name);
+    if (function_name.empty() ||
+        return_type == interpreter_.return_types.end())
+      return InferredType::kUnknown;
+
+    Object returned_object;
+    returned_object.type = return_type->second;
+    return GetInferredType(returned_object);
+  }
+
+  // Gets the type of the value the store or call |instruction| stores into
+  // its result, if the inferred slots have |types| before it.
+  InferredType GetStoredType(Bytecode* instruction,
+                             const std::vector<InferredType>& types) {
+    if (instruction->oper == _AQVM_OPERATOR_INVOKE_METHOD)
+      return GetCallType(instruction);
+
+    InferredType left = GetTypeAt(types, instruction->operand2);
+    InferredType right = instruction->size > 2
+                             ? GetTypeAt(types, instruction->operand3)
+                             : InferredType::kUnset;
+    switch (instruction->oper) {
+      case _AQVM_OPERATOR_ADDI:
+      case _AQVM_OPERATOR_SUBI:
+      case _AQVM_OPERATOR_MULI:
+      case _AQVM_OPERATOR_DIVI:
+      case _AQVM_OPERATOR_REMI:
+        return InferredType::kInt;
+      case _AQVM_OPERATOR_ADDF:
+      case _AQVM_OPERATOR_SUBF:
+      case _AQVM_OPERATOR_MULF:
+      case _AQVM_OPERATOR_DIVF:
+        return InferredType::kFloat;
+      case _AQVM_OPERATOR_CMP:
+      case _AQVM_OPERATOR_CMPI:
+      case _AQVM_OPERATOR_CMPF:
+        return InferredType::kByte;
+
+      // The generic operators compute in the wider type of their operands,
+      // and in ints on bytes.
+      case _AQVM_OPERATOR_ADD:
+      case _AQVM_OPERATOR_SUB:
+      case _AQVM_OPERATOR_MUL:
+      case _AQVM_OPERATOR_DIV:
+        if (!IsNumberType(left) || !IsNumberType(right))
+          return InferredType::kUnknown;
+        return left == InferredType::kFloat || right == InferredType::kFloat
+                   ? InferredType::kFloat
+                   : InferredType::kInt;
+      case _AQVM_OPERATOR_REM:
+        if (!IsNumberType(left) || !IsNumberType(right) ||
+            left == InferredType::kFloat || right == InferredType::kFloat)
+          return InferredType::kUnknown;
+        return InferredType::kInt;
+      case _AQVM_OPERATOR_NEG:
+        if (!IsNumberType(left)) return InferredType::kUnknown;
+        return left == InferredType::kFloat ? InferredType::kFloat
+                                            : InferredType::kInt;
+      case _AQVM_OPERATOR_EQUAL:
+        return IsNumberType(left) ? left : InferredType::kUnknown;
+      default:
+        return InferredType::kUnknown;
+    }
+  }
+
+  // Gets the number of the inferred slot |instruction| stores into, or
+  // SIZE_MAX.
+  std::size_t GetInferredResult(Bytecode* instruction) const {
+    bool is_call = instruction->oper == _AQVM_OPERATOR_INVOKE_METHOD &&
+                   instruction->size >= 3;
+    if (!IsStore(*instruction) && !is_call) return SIZE_MAX;
+    auto number =
+        inferred_numbers_.find(GetOperand(instruction, is_call ? 2 : 0));
+    return number != inferred_numbers_.end() ? number->second : SIZE_MAX;
+  }
+
+  // Infers the types the slots of the frame hold at each instruction, from
+  // the types of typed locals, parameters and literals, the types the
+  // operators produce and the types functions return. Then:
+  //  - untyped locals and temporaries that only ever hold values of one type
+  //    take that type, so that the other passes treat them as typed locals;
+  //  - generic arithmetic and comparisons on ints or floats are rewritten into
+  //    their typed forms, which check no types at run time.
+  // Only slots no reference is made to are inferred: nothing but the stores
+  // of the function and the returns of the functions it calls changes their
+  // types. The return reference is inferred as well, so that calls of the
+  // function can be typed. Returns true if slots took a type.
+  bool InferTypes() {
+    return_type_ = 0x00;
+    std::vector<std::size_t> slots;
+    std::vector<InferredType> entry_types;
+    std::size_t return_slot = SIZE_MAX;
+    if (!parameters_index_.empty()) return_slot = parameters_index_[0];
+
+    // Finds the untyped slots of the frame that are only named by known
+    // instructions and as results of calls. The return reference is only
+    // inferred if nothing but returns names it.
+    std::vector<bool> is_excluded(frame_ == nullptr ? 0 : frame_->size(),
+                                  false);
+    bool is_return_inferred = return_slot != SIZE_MAX;
+    for (std::size_t parameter : parameters_index_)
+      if (IsFrameOperand(parameter) && parameter != return_slot)
+        is_excluded[parameter & ~kFrameOperandFlag] = true;
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      Bytecode& instruction = code_[i];
+      bool is_known = IsKnownInstruction(instruction);
+      bool is_read_call = !is_known && BindsArgumentsByValue(&instruction);
+      for (std::size_t n = 0; n < instruction.size; n++) {
+        std::size_t operand = GetOperand(&code_[i], n);
+        bool is_read = is_known ? IsReadOperand(instruction, n)
+                                : is_read_call && n >= 3;
+        bool is_result = is_known ? IsStore(instruction) && n == 0
+                                  : instruction.oper ==
+                                            _AQVM_OPERATOR_INVOKE_METHOD &&
+                                        n == 2;
+        if (operand == return_slot &&
+            (is_read || !is_known ||
+             (is_result && instruction.oper != _AQVM_OPERATOR_EQUAL)))
+          is_return_inferred = false;
+        if (!is_known && !is_result && !is_read && IsFrameOperand(operand) &&
+            (operand & ~kFrameOperandFlag) < is_excluded.size())
+          is_excluded[operand & ~kFrameOperandFlag] = true;
+      }
+    }
+
+    inferred_numbers_.clear();
+    for (std::size_t i = 0; i < is_excluded.size(); i++) {
+      const Object& object = (*frame_)[i];
+      if (is_excluded[i] || object.constant_type ||
+          (i | kFrameOperandFlag) == return_slot)
+        continue;
+      inferred_numbers_[i | kFrameOperandFlag] = slots.size();
+      slots.push_back(i | kFrameOperandFlag);
+      entry_types.push_back(object.type == 0x00
+                                ? InferredType::kUninitialized
+                                : GetInferredType(object));
+    }
+    std::size_t return_number = SIZE_MAX;
+    if (is_return_inferred) {
+      return_number = slots.size();
+      inferred_numbers_[return_slot] = return_number;
+      slots.push_back(return_slot);
+      entry_types.push_back(InferredType::kUninitialized);
+    }
+    if (slots.empty() || code_.empty()) return false;
+
+    // Computes the types at each instruction until nothing changes.
+    std::vector<std::size_t> starts;
+    std::vector<std::size_t> ordinals(code_.size(), SIZE_MAX);
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      ordinals[i] = starts.size();
+      starts.push_back(i);
+    }
+    std::vector<std::vector<InferredType>> types(starts.size());
+    std::vector<InferredType> exit_types(slots.size(), InferredType::kUnset);
+    auto merge = [](std::vector<InferredType>& into,
+                    const std::vector<InferredType>& from) {
+      if (into.empty()) {
+        into = from;
+        return true;
+      }
+      bool changed = false;
+      for (std::size_t n = 0; n < into.size(); n++) {
+        InferredType type = JoinInferredTypes(into[n], from[n]);
+        changed |= type != into[n];
+        into[n] = type;
+      }
+      return changed;
+    };
+    types[0] = entry_types;
+    std::vector<std::size_t> pending = {0};
+    while (!pending.empty()) {
+      std::size_t k = pending.back();
+      pending.pop_back();
+      std::vector<InferredType> state = types[k];
+      std::size_t result = GetInferredResult(&code_[starts[k]]);
+      if (result != SIZE_MAX)
+        state[result] = GetStoredType(&code_[starts[k]], types[k]);
+
+      for (std::size_t successor : GetSuccessors(starts[k])) {
+        if (successor >= code_.size()) {
+          merge(exit_types, state);
+        } else if (merge(types[ordinals[successor]], state)) {
+          pending.push_back(ordinals[successor]);
+        }
+      }
+    }
+
+    // A slot takes a type if every store into it stores a value of that type
+    // and no instruction reads it before the first store.
+    std::vector<InferredType> stored_types(slots.size(), InferredType::kUnset);
+    std::vector<InferredType> read_types(slots.size(), InferredType::kUnset);
+    for (std::size_t k = 0; k < starts.size(); k++) {
+      Bytecode& instruction = code_[starts[k]];
+      std::size_t result = GetInferredResult(&instruction);
+      if (result != SIZE_MAX)
+        stored_types[result] = JoinInferredTypes(
+            stored_types[result],
+            types[k].empty() ? InferredType::kUnknown
+                             : GetStoredType(&instruction, types[k]));
+      bool is_known = IsKnownInstruction(instruction);
+      if (types[k].empty() ||
+          (!is_known && !BindsArgumentsByValue(&instruction)))
+        continue;
+      for (std::size_t n = 0; n < instruction.size; n++) {
+        if (is_known ? !IsReadOperand(instruction, n) : n < 3) continue;
+        auto number = inferred_numbers_.find(GetOperand(&instruction, n));
+        if (number != inferred_numbers_.end())
+          read_types[number->second] = JoinInferredTypes(
+              read_types[number->second], types[k][number->second]);
+      }
+    }
+
+    bool retyped = false;
+    for (std::size_t n = 0; n < slots.size(); n++) {
+      InferredType type = stored_types[n];
+      if (n == return_number ||
+          entry_types[n] != InferredType::kUninitialized ||
+          !IsNumberType(type) ||
+          (read_types[n] != InferredType::kUnset && read_types[n] != type))
+        continue;
+
+      // Bytes are only stored by comparisons, which already store into
+      // untyped slots, so byte slots keep an unconstant type.
+      Object& object = (*frame_)[slots[n] & ~kFrameOperandFlag];
+      object.type = type == InferredType::kByte  ? 0x01
+                    : type == InferredType::kInt ? 0x02
+                                                 : 0x03;
+      object.constant_type = type != InferredType::kByte;
+      object.data.uint64t_data = 0;
+      for (std::vector<InferredType>& state : types)
+        if (!state.empty()) state[n] = type;
+      optimizer_stats.inferred_slot_count++;
+      retyped = true;
+    }
+
+    if (return_number != SIZE_MAX) {
+      switch (exit_types[return_number]) {
+        case InferredType::kByte:
+          return_type_ = 0x01;
+          break;
+        case InferredType::kInt:
+          return_type_ = 0x02;
+          break;
+        case InferredType::kFloat:
+          return_type_ = 0x03;
+          break;
+        default:
+          break;
+      }
+    }
+
+    for (std::size_t k = 0; k < starts.size(); k++)
+      if (!types[k].empty()) SpecializeInstruction(code_[starts[k]], types[k]);
+    return retyped;
+  }
+
+  // Rewrites the generic arithmetic or comparison |instruction| into its int
+  // or float form if the inferred slots have |types| before it and its
+  // operands and result hold values of the type.
+  void SpecializeInstruction(Bytecode& instruction,
+                             const std::vector<InferredType>& types) {
+    static const std::unordered_map<uint8_t, std::pair<uint8_t, uint8_t>>
+        typed_forms = {
+            {_AQVM_OPERATOR_ADD, {_AQVM_OPERATOR_ADDI, _AQVM_OPERATOR_ADDF}},
+            {_AQVM_OPERATOR_SUB, {_AQVM_OPERATOR_SUBI, _AQVM_OPERATOR_SUBF}},
+            {_AQVM_OPERATOR_MUL, {_AQVM_OPERATOR_MULI, _AQVM_OPERATOR_MULF}},
+            {_AQVM_OPERATOR_DIV, {_AQVM_OPERATOR_DIVI, _AQVM_OPERATOR_DIVF}},
+            {_AQVM_OPERATOR_REM, {_AQVM_OPERATOR_REMI, _AQVM_OPERATOR_NOP}},
+            {_AQVM_OPERATOR_CMP, {_AQVM_OPERATOR_CMPI, _AQVM_OPERATOR_CMPF}}};
+    auto forms = typed_forms.find(instruction.oper);
+    if (forms == typed_forms.end()) return;
+
+    bool is_compare = instruction.oper == _AQVM_OPERATOR_CMP;
+    if (instruction.size != (is_compare ? 4 : 3) ||
+        (is_compare && instruction.operand2 > 0x05))
+      return;
+    InferredType result = GetTypeAt(types, instruction.operand1);
+    std::size_t left_operand =
+        is_compare ? instruction.operand3 : instruction.operand2;
+    std::size_t right_operand =
+        is_compare ? instruction.operand4 : instruction.operand3;
+    InferredType left = GetTypeAt(types, left_operand);
+    InferredType right = GetTypeAt(types, right_operand);
+    if (left != right || result != (is_compare ? InferredType::kByte : left))
+      return;
+
+    uint8_t oper = _AQVM_OPERATOR_NOP;
+    if (left == InferredType::kInt) oper = forms->second.first;
+    if (left == InferredType::kFloat) oper = forms->second.second;
+    if (oper == _AQVM_OPERATOR_NOP) return;
+    instruction.oper = oper;
+    optimizer_stats.specialized_count++;
+  }
+
+  // Gets the function whose code can replace the call |instruction|, or
+  // nullptr. The function must have one overload, and the arguments must
+  // hold numbers of the types of its parameters, so that copying them into
+  // the parameters binds them as the call did.
+  const InlineCandidate* GetInlineCandidate(Bytecode* instruction) {
+    if (instruction->oper != _AQVM_OPERATOR_INVOKE_METHOD ||
+        instruction->size < 3)
+      return nullptr;
+    std::size_t overload_count = 0;
+    std::string function_name = GetCalledFunction(instruction, overload_count);
+    auto candidate = interpreter_.inline_candidates.find(function_name);
+    if (function_name.empty() || overload_count != 1 ||
+        candidate == interpreter_.inline_candidates.end())
+      return nullptr;
+
+    const InlineCandidate& callee = candidate->second;
+    if (instruction->size < 2 ||
+        static_cast<std::size_t>(instruction->size) - 2 !=
+            callee.parameters.size())
+      return nullptr;
+    for (std::size_t n = 1; n < callee.parameters.size(); n++) {
+      InferredType argument = GetStaticType(GetOperand(instruction, n + 2));
+      const Object& parameter =
+          callee.frame[callee.parameters[n] & ~kFrameOperandFlag];
+      if (!IsNumberType(argument)) return nullptr;
+      if (!parameter.constant_type) continue;
+
+      // Ints convert to floats silently, other conversions warn.
+      InferredType type = GetInferredType(parameter);
+      if (type != argument &&
+          (type != InferredType::kFloat || argument != InferredType::kInt))
+        return nullptr;
+    }
+    return &callee;
+  }
+
+  // Appends a copy of the code of |callee| in place of the |call| to |code|.
+  // The slots the code names are added to the end of the frame, the
+  // arguments are copied into the parameters first, and returns store into
+  // the result of the call and jump past the copy.
+  void AppendInlinedCall(Bytecode* call, const InlineCandidate& callee,
+                         std::vector<Bytecode>& code) {
+    std::unordered_map<std::size_t, std::size_t> slots;
+    slots[callee.parameters[0]] = GetOperand(call, 2);
+    auto rename = [&](std::size_t operand) -> std::size_t {
+      if (!IsFrameOperand(operand)) return operand;
+      auto slot = slots.find(operand);
+      if (slot != slots.end()) return slot->second;
+      std::size_t renamed = frame_->size() | kFrameOperandFlag;
+      frame_->push_back(callee.frame[operand & ~kFrameOperandFlag]);
+      slots[operand] = renamed;
+      return renamed;
+    };
+
+    for (std::size_t n = 1; n < callee.parameters.size(); n++)
+      code.push_back(Bytecode(_AQVM_OPERATOR_EQUAL,
+                              {rename(callee.parameters[n]),
+                               GetOperand(call, n + 2)}));
+
+    std::size_t base = code.size();
+    code.insert(code.end(), callee.code.begin(), callee.code.end());
+    for (std::size_t i = base; i < code.size();
+         i += 1 + code[i].GetExtensionSize()) {
+      for (std::size_t n = 0; n < code[i].size; n++) {
+        uint32_t& operand = GetOperand(&code[i], n);
+        operand = rename(operand);
+      }
+      if (code[i].oper == _AQVM_OPERATOR_GOTO) {
+        code[i].operand1 += base;
+      } else if (code[i].oper == _AQVM_OPERATOR_IF) {
+        code[i].operand2 += base;
+        code[i].operand3 += base;
+      }
+    }
+  }
+
+  // Replaces the calls of small functions with copies of their code, which
+  // saves the lookup, the binding of the arguments and the frame of each
+  // call, and lets the other passes optimize the copies along with the code
+  // around them. The copies aren't inlined into again. Returns true if calls
+  // were inlined.
+  bool InlineCalls() {
+    if (frame_ == nullptr || inline_limit == 0) return false;
+
+    std::vector<Bytecode> code;
+    std::vector<std::size_t> new_index(code_.size() + 1);
+    std::vector<std::size_t> jumps;
+    bool inlined = false;
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      new_index[i] = code.size();
+      const InlineCandidate* callee = GetInlineCandidate(&code_[i]);
+      if (callee != nullptr &&
+          code.size() + code_.size() - i + callee->code.size() <=
+              kMaxInliningCallerSize) {
+        AppendInlinedCall(&code_[i], *callee, code);
+        optimizer_stats.inlined_call_count++;
+        inlined = true;
+        continue;
+      }
+
+      if (code_[i].oper == _AQVM_OPERATOR_GOTO ||
+          code_[i].oper == _AQVM_OPERATOR_IF)
+        jumps.push_back(code.size());
+      for (std::size_t j = 0; j <= code_[i].GetExtensionSize(); j++)
+        code.push_back(code_[i + j]);
+    }
+    if (!inlined) return false;
+    new_index[code_.size()] = code.size();
+
+    // Jumps of the function itself land on the new places of their targets.
+    for (std::size_t i : jumps) {
+      if (code[i].oper == _AQVM_OPERATOR_GOTO) {
+        code[i].operand1 = new_index[code[i].operand1];
+      } else {
+        code[i].operand2 = new_index[code[i].operand2];
+        code[i].operand3 = new_index[code[i].operand3];
+      }
+    }
+    code_.swap(code);
+    return true;
+  }
+
+  // Rewrites a temporary that is stored once and then copied into a variable
+  // by the next instruction, as in "y = x + 1", to store into the variable
+  // directly. The variable only has to be a typed local: the store happens at
+  // the same point as the copy did, so calls and references see no
+  // difference.
+  bool CoalesceCopies() {
+    std::unordered_map<std::size_t, std::size_t> use_counts;
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      if (!IsKnownInstruction(code_[i])) continue;
+      for (std::size_t n = 0; n < code_[i].size; n++) {
+        if (n != 0 && !IsReadOperand(code_[i], n)) continue;
+        std::size_t operand = GetOperand(&code_[i], n);
+        if (IsTracked(operand)) use_counts[operand]++;
+      }
+    }
+
+    std::unordered_set<std::size_t> targets = GetJumpTargets();
+    std::vector<bool> removed(code_.size(), false);
+    bool changed = false;
+    for (std::size_t i = 0; i + 1 < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      Bytecode& store = code_[i];
+      Bytecode& copy = code_[i + 1];
+      if (!IsStore(store) || copy.oper != _AQVM_OPERATOR_EQUAL ||
+          copy.size != 2 || copy.operand2 != store.operand1 ||
+          targets.count(i + 1) != 0)
+        continue;
+
+      std::size_t temporary = store.operand1;
+      std::size_t variable = copy.operand1;
+      if (!IsTracked(temporary) || !IsTypedLocal(variable) ||
+          temporary == variable || use_counts[temporary] != 2 ||
+          GetSlotObject(temporary).type != GetSlotObject(variable).type)
+        continue;
+
+      store.operand1 = variable;
+      removed[i + 1] = true;
+      optimizer_stats.coalesced_count++;
+      changed = true;
+      i++;
+    }
+
+    if (changed) Compact(removed);
+    return changed;
+  }
+
+  // Computes ADDI to DIVF on two literals at compile time. Divisions that
+  // would fault at run time are left alone. Returns false if |instruction|
+  // can't be folded, and stores the slot of the literal holding the result
+  // into |literal| otherwise.
+  bool FoldArithmetic(const Bytecode& instruction, std::size_t& literal) {
+    uint8_t type = 0x00;
+    if (instruction.oper >= _AQVM_OPERATOR_ADDI &&
+        instruction.oper <= _AQVM_OPERATOR_REMI)
+      type = 0x02;
+    if (instruction.oper >= _AQVM_OPERATOR_ADDF &&
+        instruction.oper <= _AQVM_OPERATOR_DIVF)
+      type = 0x03;
+    if (type == 0x00 || instruction.size != 3 ||
+        !IsTypedLocal(instruction.operand1) ||
+        !IsLiteral(instruction.operand2) || !IsLiteral(instruction.operand3) ||
+        GetSlotObject(instruction.operand1).type != type ||
+        GetSlotObject(instruction.operand2).type != type ||
+        GetSlotObject(instruction.operand3).type != type)
+      return false;
+
+    if (type == 0x03) {
+      double left = GetSlotObject(instruction.operand2).data.float_data;
+      double right = GetSlotObject(instruction.operand3).data.float_data;
+      double value = left / right;
+      if (instruction.oper == _AQVM_OPERATOR_ADDF) value = left + right;
+      if (instruction.oper == _AQVM_OPERATOR_SUBF) value = left - right;
+      if (instruction.oper == _AQVM_OPERATOR_MULF) value = left * right;
+      literal = AddFloatLiteral(interpreter_, value);
+      return true;
+    }
+
+    // Wraps around on overflow like the instructions do.
+    uint64_t left = GetSlotObject(instruction.operand2).data.int_data;
+    uint64_t right = GetSlotObject(instruction.operand3).data.int_data;
+    int64_t value = 0;
+    switch (instruction.oper) {
+      case _AQVM_OPERATOR_ADDI:
+        value = static_cast<int64_t>(left + right);
+        break;
+      case _AQVM_OPERATOR_SUBI:
+        value = static_cast<int64_t>(left - right);
+        break;
+      case _AQVM_OPERATOR_MULI:
+        value = static_cast<int64_t>(left * right);
+        break;
+      default: {
+        int64_t dividend = static_cast<int64_t>(left);
+        int64_t divisor = static_cast<int64_t>(right);
+        if (divisor == 0 ||
+            (divisor == -1 && dividend == std::numeric_limits<int64_t>::min()))
+          return false;
+        value = instruction.oper == _AQVM_OPERATOR_DIVI ? dividend / divisor
+                                                        : dividend % divisor;
+        break;
+      }
+    }
+    literal = AddIntLiteral(interpreter_, value);
+    return true;
+  }
+
+  // Within each basic block, remembers which tracked slots hold a copy of
+  // another tracked slot or of a literal and reads the original instead.
+  // Arithmetic on literals is folded on the way, and conditional jumps on
+  // literals become GOTOs.
+  bool PropagateValues() {
+    std::unordered_set<std::size_t> targets = GetJumpTargets();
+    std::unordered_map<std::size_t, std::size_t> values;
+    bool changed = false;
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      if (targets.count(i) != 0) values.clear();
+      Bytecode& instruction = code_[i];
+      if (!IsKnownInstruction(instruction)) continue;
+
+      for (std::size_t n = 0; n < instruction.size; n++) {
+        if (!IsReadOperand(instruction, n)) continue;
+        uint32_t& operand = GetOperand(&instruction, n);
+        auto value = values.find(operand);
+        if (value == values.end()) continue;
+        operand = value->second;
+        optimizer_stats.propagated_count++;
+        changed = true;
+      }
+
+      if (instruction.oper == _AQVM_OPERATOR_IF &&
+          IsLiteral(instruction.operand1)) {
+        std::size_t target = GetByte(&GetSlotObject(instruction.operand1)) != 0
+                                 ? instruction.operand2
+                                 : instruction.operand3;
+        instruction = Bytecode(_AQVM_OPERATOR_GOTO, {target});
+        optimizer_stats.folded_branch_count++;
+        changed = true;
+      }
+      if (instruction.oper == _AQVM_OPERATOR_IF ||
+          instruction.oper == _AQVM_OPERATOR_GOTO) {
+        values.clear();
+        continue;
+      }
+      if (!IsStore(instruction)) continue;
+
+      std::size_t folded = 0;
+      if (FoldArithmetic(instruction, folded)) {
+        instruction =
+            Bytecode(_AQVM_OPERATOR_EQUAL, {instruction.operand1, folded});
+        optimizer_stats.folded_count++;
+        changed = true;
+      }
+
+      std::size_t result = instruction.operand1;
+      values.erase(result);
+      for (auto value = values.begin(); value != values.end();) {
+        if (value->second == result) {
+          value = values.erase(value);
+        } else {
+          value++;
+        }
+      }
+
+      if (instruction.oper == _AQVM_OPERATOR_EQUAL && IsTracked(result) &&
+          instruction.operand2 != result &&
+          (IsTracked(instruction.operand2) ||
+           IsLiteral(instruction.operand2)) &&
+          GetSlotObject(instruction.operand2).type ==
+              GetSlotObject(result).type)
+        values[result] = instruction.operand2;
+    }
+    return changed;
+  }
+
+  // Returns true if |instruction| can't fault or have an effect other than
+  // its store when it runs.
+  bool HasNoSideEffects(Bytecode& instruction) {
+    switch (instruction.oper) {
+      case _AQVM_OPERATOR_ADDI:
+      case _AQVM_OPERATOR_SUBI:
+      case _AQVM_OPERATOR_MULI:
+      case _AQVM_OPERATOR_ADDF:
+      case _AQVM_OPERATOR_SUBF:
+      case _AQVM_OPERATOR_MULF:
+      case _AQVM_OPERATOR_DIVF:
+      case _AQVM_OPERATOR_CMPI:
+      case _AQVM_OPERATOR_CMPF:
+        return true;
+
+      case _AQVM_OPERATOR_DIVI:
+      case _AQVM_OPERATOR_REMI: {
+        if (!IsLiteral(instruction.operand3)) return false;
+        int64_t divisor = GetSlotObject(instruction.operand3).data.int_data;
+        return divisor != 0 && divisor != -1;
+      }
+
+      case _AQVM_OPERATOR_ADD:
+      case _AQVM_OPERATOR_SUB:
+      case _AQVM_OPERATOR_MUL:
+      case _AQVM_OPERATOR_NEG:
+      case _AQVM_OPERATOR_EQUAL:
+        // The generic operators only can't fault on numbers.
+        for (std::size_t n = 1; n < instruction.size; n++) {
+          std::size_t operand = GetOperand(&instruction, n);
+          if (!IsNumberType(GetStaticType(operand))) return false;
+        }
+        return true;
+
+      default:
+        return false;
+    }
+  }
+
+  // Removes stores into tracked slots that no instruction reads.
+  bool RemoveDeadStores() {
+    bool changed = false;
+    bool removed_any = true;
+    while (removed_any) {
+      std::unordered_map<std::size_t, std::size_t> read_counts;
+      for (std::size_t i = 0; i < code_.size();
+           i += 1 + code_[i].GetExtensionSize()) {
+        if (!IsKnownInstruction(code_[i])) continue;
+        for (std::size_t n = 0; n < code_[i].size; n++) {
+          if (!IsReadOperand(code_[i], n)) continue;
+          std::size_t operand = GetOperand(&code_[i], n);
+          if (IsTracked(operand)) read_counts[operand]++;
+        }
+      }
+
+      std::vector<bool> removed(code_.size(), false);
+      removed_any = false;
+      for (std::size_t i = 0; i < code_.size();
+           i += 1 + code_[i].GetExtensionSize()) {
+        if (!IsStore(code_[i]) || !IsTracked(code_[i].operand1) ||
+            read_counts.count(code_[i].operand1) != 0 ||
+            !HasNoSideEffects(code_[i]))
+          continue;
+        removed[i] = true;
+        optimizer_stats.dead_store_count++;
+        removed_any = true;
+      }
+
+      if (removed_any) {
+        Compact(removed);
+        changed = true;
+      }
+    }
+    return changed;
+  }
+
+  // Removes the instructions no path from the entry reaches, such as the code
+  // after a return or a branch on a literal.
+  bool RemoveUnreachableCode() {
+    std::vector<bool> reachable(code_.size(), false);
+    std::vector<std::size_t> pending = {0};
+    while (!pending.empty()) {
+      std::size_t i = pending.back();
+      pending.pop_back();
+      if (i >= code_.size() || reachable[i]) continue;
+      reachable[i] = true;
+
+      const Bytecode& instruction = code_[i];
+      if (instruction.oper == _AQVM_OPERATOR_GOTO) {
+        pending.push_back(instruction.operand1);
+      } else if (instruction.oper == _AQVM_OPERATOR_IF) {
+        pending.push_back(instruction.operand2);
+        pending.push_back(instruction.operand3);
+      } else {
+        pending.push_back(i + 1 + instruction.GetExtensionSize());
+      }
+    }
+
+    std::vector<bool> removed(code_.size(), false);
+    bool changed = false;
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      if (reachable[i]) continue;
+      for (std::size_t j = 0; j <= code_[i].GetExtensionSize(); j++)
+        removed[i + j] = true;
+      optimizer_stats.unreachable_count++;
+      changed = true;
+    }
+
+    if (changed) Compact(removed);
+    return changed;
+  }
+
+  // Gets where a jump to |target| ends up, following NOPs and GOTOs. Branches
+  // only follow GOTOs forward: a GOTO back is the safe point of a loop, where
+  // the collector runs, so every iteration must still pass it.
+  std::size_t ResolveJumpTarget(std::size_t target, bool is_goto) const {
+    for (std::size_t hops = 0; hops < code_.size(); hops++) {
+      while (target < code_.size() && code_[target].oper == _AQVM_OPERATOR_NOP)
+        target++;
+      if (target >= code_.size() || code_[target].oper != _AQVM_OPERATOR_GOTO)
+        break;
+
+      std::size_t next_target = code_[target].operand1;
+      if (next_target == target || (!is_goto && next_target < target)) break;
+      target = next_target;
+    }
+    return target;
+  }
+
+  // Retargets the jumps that land on NOPs or on GOTOs to where they lead.
+  void ThreadJumps() {
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      Bytecode& instruction = code_[i];
+      if (instruction.oper == _AQVM_OPERATOR_GOTO) {
+        std::size_t target = ResolveJumpTarget(instruction.operand1, true);
+        if (target == instruction.operand1) continue;
+        instruction.operand1 = target;
+        optimizer_stats.threaded_jump_count++;
+      } else if (instruction.oper == _AQVM_OPERATOR_IF) {
+        std::size_t true_target =
+            ResolveJumpTarget(instruction.operand2, false);
+        std::size_t false_target =
+            ResolveJumpTarget(instruction.operand3, false);
+        if (true_target != instruction.operand2)
+          optimizer_stats.threaded_jump_count++;
+        if (false_target != instruction.operand3)
+          optimizer_stats.threaded_jump_count++;
+        instruction.operand2 = true_target;
+        instruction.operand3 = false_target;
+      }
+    }
+  }
+
+  // Removes the NOPs, which only were landing pads for jumps, and the GOTOs
+  // that land on the instruction after them once the NOPs are gone, such as
+  // the GOTO over an empty else branch or the return at the end of a
+  // function.
+  void RemoveNopsAndJumpsToNext() {
+    std::vector<bool> removed(code_.size(), false);
+    std::vector<std::size_t> gotos;
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      if (code_[i].oper == _AQVM_OPERATOR_NOP) {
+        removed[i] = true;
+        optimizer_stats.removed_nop_count++;
+      } else if (code_[i].oper == _AQVM_OPERATOR_GOTO) {
+        gotos.push_back(i);
+      }
+    }
+
+    // From the last GOTO back, so that GOTOs landing on removed GOTOs go too.
+    for (auto i = gotos.rbegin(); i != gotos.rend(); i++) {
+      std::size_t target = code_[*i].operand1;
+      if (target <= *i) continue;
+      bool lands_on_next = true;
+      for (std::size_t j = *i + 1; j < target && lands_on_next; j++)
+        lands_on_next = removed[j];
+      if (!lands_on_next) continue;
+      removed[*i] = true;
+      optimizer_stats.removed_jump_count++;
+    }
+
+    Compact(removed);
+  }
+
+  // Gets the class of each slot of the frame for PackFrameSlots(). Only slots
+  // of the same class share a slot. Slots of int and float type always hold
+  // a number of their type, whatever was stored in them before. Untyped
+  // slots only written by comparisons always hold a byte once written, and
+  // byte slots only written by them always do. Other slots can hold
+  // references, which stores write through, so they are never shared.
+  std::vector<SlotClass> GetSlotClasses() const {
+    std::vector<Object>& frame = *frame_;
+    std::vector<SlotClass> classes(frame.size(), SlotClass::kFixed);
+    for (std::size_t i = 0; i < frame.size(); i++) {
+      if (frame[i].data.uint64t_data != 0) continue;
+      if (frame[i].constant_type && frame[i].type == 0x02)
+        classes[i] = SlotClass::kInt;
+      if (frame[i].constant_type && frame[i].type == 0x03)
+        classes[i] = SlotClass::kFloat;
+      if (!frame[i].constant_type && frame[i].type == 0x01)
+        classes[i] = SlotClass::kByte;
+      if (!frame[i].constant_type && frame[i].type == 0x00)
+        classes[i] = SlotClass::kCompareResult;
+    }
+    for (std::size_t parameter : parameters_index_)
+      if (IsFrameOperand(parameter))
+        classes[parameter & ~kFrameOperandFlag] = SlotClass::kFixed;
+
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      const Bytecode& instruction = code_[i];
+      if (IsStore(instruction)) {
+        if (!IsFrameOperand(instruction.operand1) || IsCompare(instruction))
+          continue;
+        SlotClass& slot_class =
+            classes[instruction.operand1 & ~kFrameOperandFlag];
+        if (slot_class == SlotClass::kByte ||
+            slot_class == SlotClass::kCompareResult)
+          slot_class = SlotClass::kFixed;
+        continue;
+      }
+      if (IsKnownInstruction(instruction)) continue;
+
+      // Calls and element accesses only use their operands while they run.
+      // Other instructions, such as REFER, may keep a pointer to the slot.
+      bool keeps_slots = instruction.oper != _AQVM_OPERATOR_INVOKE_METHOD &&
+                         instruction.oper !=
+                             _AQVM_OPERATOR_INVOKE_MODULE_METHOD &&
+                         instruction.oper != _AQVM_OPERATOR_ARRAY;
+      for (std::size_t n = 0; n < instruction.size; n++) {
+        std::size_t operand = GetOperand(&code_[i], n);
+        if (!IsFrameOperand(operand)) continue;
+        SlotClass& slot_class = classes[operand & ~kFrameOperandFlag];
+        if (keeps_slots || slot_class == SlotClass::kByte ||
+            slot_class == SlotClass::kCompareResult)
+          slot_class = SlotClass::kFixed;
+      }
+    }
+    return classes;
+  }
+
+  // Lets locals and temporaries whose lifetimes don't overlap share a slot of
+  // the frame, and shrinks the frame. Every call copies the frame, so smaller
+  // frames make calls cheaper and keep the slots in use on fewer cache lines.
+  void PackFrameSlots() {
+    if (frame_ == nullptr || frame_->size() < 2) return;
+    std::vector<SlotClass> classes = GetSlotClasses();
+
+    // Numbers the slots that may be shared.
+    std::vector<std::size_t> slots;
+    std::vector<std::size_t> slot_numbers(frame_->size(), SIZE_MAX);
+    for (std::size_t i = 0; i < frame_->size(); i++) {
+      if (classes[i] == SlotClass::kFixed) continue;
+      slot_numbers[i] = slots.size();
+      slots.push_back(i);
+    }
+    if (slots.size() < 2) return;
+    std::size_t words = (slots.size() + 63) / 64;
+
+    // Gets the slots each instruction reads and writes, and where it may go
+    // next. The other instructions are treated as reading and writing all of
+    // their operands.
+    std::vector<std::size_t> starts;
+    std::vector<std::size_t> ordinals(code_.size() + 1, SIZE_MAX);
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      ordinals[i] = starts.size();
+      starts.push_back(i);
+    }
+    std::vector<std::vector<std::size_t>> uses(starts.size());
+    std::vector<std::vector<std::size_t>> defs(starts.size());
+    std::vector<std::vector<std::size_t>> successors(starts.size());
+    for (std::size_t k = 0; k < starts.size(); k++) {
+      std::size_t i = starts[k];
+      Bytecode& instruction = code_[i];
+      auto add = [&](std::vector<std::size_t>& list, std::size_t operand) {
+        if (IsFrameOperand(operand) &&
+            slot_numbers[operand & ~kFrameOperandFlag] != SIZE_MAX)
+          list.push_back(slot_numbers[operand & ~kFrameOperandFlag]);
+      };
+      if (IsKnownInstruction(instruction)) {
+        if (IsStore(instruction)) add(defs[k], instruction.operand1);
+        for (std::size_t n = 0; n < instruction.size; n++)
+          if (IsReadOperand(instruction, n))
+            add(uses[k], GetOperand(&instruction, n));
+      } else {
+        for (std::size_t n = 0; n < instruction.size; n++) {
+          add(uses[k], GetOperand(&instruction, n));
+          add(defs[k], GetOperand(&instruction, n));
+        }
+      }
+
+      std::vector<std::size_t> targets;
+      if (instruction.oper == _AQVM_OPERATOR_GOTO) {
+        targets.push_back(instruction.operand1);
+      } else if (instruction.oper == _AQVM_OPERATOR_IF) {
+        targets.push_back(instruction.operand2);
+        targets.push_back(instruction.operand3);
+      } else {
+        targets.push_back(i + 1 + instruction.GetExtensionSize());
+      }
+      for (std::size_t target : targets)
+        if (target < code_.size()) successors[k].push_back(ordinals[target]);
+    }
+
+    // Computes the slots live into each instruction until nothing changes.
+    std::vector<std::vector<uint64_t>> live_in(
+        starts.size(), std::vector<uint64_t>(words, 0));
+    std::vector<uint64_t> live(words);
+    auto get_live_out = [&](std::size_t k) {
+      std::fill(live.begin(), live.end(), 0);
+      for (std::size_t successor : successors[k])
+        for (std::size_t w = 0; w < words; w++)
+          live[w] |= live_in[successor][w];
+    };
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (std::size_t k = starts.size(); k-- > 0;) {
+        get_live_out(k);
+        for (std::size_t def : defs[k])
+          live[def / 64] &= ~(uint64_t(1) << (def % 64));
+        for (std::size_t use : uses[k])
+          live[use / 64] |= uint64_t(1) << (use % 64);
+        if (live != live_in[k]) {
+          live_in[k] = live;
+          changed = true;
+        }
+      }
+    }
+
+    // Two slots interfere if one is written while the other is live, or if
+    // both are operands of an instruction that isn't modelled.
+    std::vector<std::vector<uint64_t>> interferes(
+        slots.size(), std::vector<uint64_t>(words, 0));
+    auto interfere = [&](std::size_t a, std::size_t b) {
+      if (a == b) return;
+      interferes[a][b / 64] |= uint64_t(1) << (b % 64);
+      interferes[b][a / 64] |= uint64_t(1) << (a % 64);
+    };
+    for (std::size_t k = 0; k < starts.size(); k++) {
+      get_live_out(k);
+      for (std::size_t def : defs[k])
+        for (std::size_t b = 0; b < slots.size(); b++)
+          if ((live[b / 64] >> (b % 64)) & 1) interfere(def, b);
+      if (!IsKnownInstruction(code_[starts[k]]))
+        for (std::size_t a : uses[k])
+          for (std::size_t b : uses[k]) interfere(a, b);
+    }
+
+    // Gives each slot the first shared slot of its class that no slot it
+    // interferes with took, and numbers the new frame in the old order.
+    std::vector<std::size_t> colors(slots.size());
+    std::vector<std::vector<std::size_t>> members;
+    std::vector<SlotClass> color_classes;
+    for (std::size_t a = 0; a < slots.size(); a++) {
+      std::size_t color = 0;
+      for (; color < members.size(); color++) {
+        if (color_classes[color] != classes[slots[a]]) continue;
+        bool is_free = true;
+        for (std::size_t b : members[color])
+          if ((interferes[a][b / 64] >> (b % 64)) & 1) is_free = false;
+        if (is_free) break;
+      }
+      if (color == members.size()) {
+        members.emplace_back();
+        color_classes.push_back(classes[slots[a]]);
+      }
+      members[color].push_back(a);
+      colors[a] = color;
+    }
+    if (members.size() == slots.size()) return;
+
+    std::vector<Object>& frame = *frame_;
+    std::vector<std::size_t> new_indexes(frame.size());
+    std::vector<std::size_t> color_indexes(members.size(), SIZE_MAX);
+    std::vector<Object> new_frame;
+    for (std::size_t i = 0; i < frame.size(); i++) {
+      if (slot_numbers[i] != SIZE_MAX) {
+        std::size_t& index = color_indexes[colors[slot_numbers[i]]];
+        if (index == SIZE_MAX) {
+          index = new_frame.size();
+          new_frame.push_back(frame[i]);
+        }
+        new_indexes[i] = index;
+      } else {
+        new_indexes[i] = new_frame.size();
+        new_frame.push_back(frame[i]);
+      }
+    }
+
+    for (std::size_t i = 0; i < code_.size();
+         i += 1 + code_[i].GetExtensionSize()) {
+      for (std::size_t n = 0; n < code_[i].size; n++) {
+        uint32_t& operand = GetOperand(&code_[i], n);
+        if (IsFrameOperand(operand))
+          operand = new_indexes[operand & ~kFrameOperandFlag] |
+                    kFrameOperandFlag;
+      }
+    }
+    for (std::size_t& parameter : parameters_index_)
+      if (IsFrameOperand(parameter))
+        parameter =
+            new_indexes[parameter & ~kFrameOperandFlag] | kFrameOperandFlag;
+
+    optimizer_stats.packed_slot_count += frame.size() - new_frame.size();
+    frame.swap(new_frame);
+  }
+
+  // Erases the |removed| words from the code. Jumps to a removed instruction
+  // land on the next instruction that is kept.
+  void Compact(const std::vector<bool>& removed) {
+    std::vector<std::size_t> new_index(code_.size() + 1);
+    std::size_t kept_count = 0;
+    for (std::size_t i = 0; i < code_.size(); i++) {
+      new_index[i] = kept_count;
+      if (!removed[i]) kept_count++;
+    }
+    new_index[code_.size()] = kept_count;
+
+    std::vector<Bytecode> code;
+    code.reserve(kept_count);
+    for (std::size_t i = 0; i < code_.size(); i++) {
+      if (removed[i]) continue;
+      code.push_back(code_[i]);
+      Bytecode& instruction = code.back();
+      if (instruction.oper == _AQVM_OPERATOR_GOTO) {
+        instruction.operand1 = new_index[instruction.operand1];
+      } else if (instruction.oper == _AQVM_OPERATOR_IF) {
+        instruction.operand2 = new_index[instruction.operand2];
+        instruction.operand3 = new_index[instruction.operand3];
+      }
+
+      // Extension words are copied as they are.
+      for (std::size_t j = 0; j < code_[i].GetExtensionSize(); j++)
+        code.push_back(code_[++i]);
+    }
+    code_.swap(code);
+  }
+
+  Interpreter& interpreter_;
+  std::vector<Object>* frame_;
+  std::vector<std::size_t>& parameters_index_;
+  std::vector<Bytecode>& code_;
+
+  // Whether each slot of the frame is a typed local, and whether it is
+  // tracked.
+  std::vector<bool> typed_locals_;
+  std::vector<bool> tracked_;
+
+  // The global slots the function may write. Literals among them aren't
+  // folded.
+  std::unordered_set<std::size_t> written_globals_;
+
+  // The number of each slot InferTypes() infers, and the vm type the function
+  // returns.
+  std::unordered_map<std::size_t, std::size_t> inferred_numbers_;
+  uint8_t return_type_ = 0x00;
+};
+
+uint8_t OptimizeFunction(Interpreter& interpreter,
+                         std::vector<std::size_t>& parameters_index,
+                         std::vector<Bytecode>& code) {
+  if (optimization_level < 1) return 0x00;
+
+  std::vector<Object>* frame = nullptr;
+  auto function_context = interpreter.context.function_context;
+  if (function_context != nullptr && function_context->has_frame)
+    frame = &function_context->frame;
+
+  BytecodeOptimizer optimizer(interpreter, frame, parameters_index, code);
+  optimizer.Run();
+  return optimizer.GetReturnType();
+}
+
+void AddInlineCandidate(Interpreter& interpreter, const std::string& name,
+                        std::vector<std::size_t>& parameters_index,
+                        std::vector<Bytecode>& code, bool is_variadic) {
+  auto function_context = interpreter.context.function_context;
+  if (optimization_level < 1 || code.size() > inline_limit || is_variadic ||
+      function_context == nullptr || !function_context->has_frame ||
+      parameters_index.empty())
+    return;
+  std::vector<Object>& frame = function_context->frame;
+  for (std::size_t parameter : parameters_index)
+    if (!IsFrameOperand(parameter) ||
+        (parameter & ~kFrameOperandFlag) >= frame.size())
+      return;
+
+  // The parameters must be numbers or untyped, so that the copies bind them
+  // with EQUAL. References aren't bound.
+  std::size_t return_reference = parameters_index[0];
+  for (std::size_t n = 1; n < parameters_index.size(); n++) {
+    const Object& parameter = frame[parameters_index[n] & ~kFrameOperandFlag];
+    if (parameter.constant_type ? parameter.type < 0x01 || parameter.type > 0x03
+                                : parameter.type != 0x00)
+      return;
+  }
+
+  // Only stores, jumps and calls of functions are copied. They never make a
+  // reference to a slot, so the slots of the copies only hold values. The
+  // slots must hold numbers or be untyped, and the return reference is only
+  // stored into by returns.
+  std::vector<Object>& memory = interpreter.global_memory->GetMemory();
+  for (std::size_t i = 0; i < code.size();
+       i += 1 + code[i].GetExtensionSize()) {
+    Bytecode& instruction = code[i];
+    if (instruction.oper == _AQVM_OPERATOR_INVOKE_METHOD) {
+      std::size_t callee = GetOperand(&code[i], 1);
+      if (instruction.size < 3 || instruction.operand1 != 2) return;
+      if (!IsFrameOperand(callee) && !IsImmediateOperand(callee) &&
+          callee < memory.size() && memory[callee].type == 0x05 &&
+          GetString(&memory[callee]) == name)
+        return;
+    } else if (!IsKnownInstruction(instruction)) {
+      return;
+    }
+
+    for (std::size_t n = 0; n < instruction.size; n++) {
+      std::size_t operand = GetOperand(&code[i], n);
+      if (operand == return_reference) {
+        if (instruction.oper != _AQVM_OPERATOR_EQUAL || n != 0) return;
+        continue;
+      }
+      if (!IsFrameOperand(operand)) continue;
+      std::size_t index = operand & ~kFrameOperandFlag;
+      if (index >= frame.size() || frame[index].type > 0x03) return;
+    }
+  }
+  if (MayReadUnwrittenSlots(code, parameters_index)) return;
+
+  interpreter.inline_candidates[name] = {parameters_index, frame, code};
+}
+
+const OptimizerStats& GetOptimizerStats() { return optimizer_stats; }
+}  // namespace Interpreter
+}  // namespace Aq
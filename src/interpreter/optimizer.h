@@ -0,0 +1,106 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#ifndef AQ_INTERPRETER_OPTIMIZER_H_
+#define AQ_INTERPRETER_OPTIMIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "interpreter/bytecode.h"
+#include "interpreter/interpreter.h"
+
+namespace Aq {
+namespace Interpreter {
+// The counters of the optimizer, summed over all optimized functions.
+struct OptimizerStats {
+  std::size_t optimized_function_count = 0;
+
+  // Arithmetic on literals computed at compile time, and conditional jumps on
+  // literals turned into GOTOs.
+  std::size_t folded_count = 0;
+  std::size_t folded_branch_count = 0;
+
+  // Reads of a copied slot or of a slot holding a literal that were replaced
+  // by reads of the original.
+  std::size_t propagated_count = 0;
+
+  // Copies of temporaries removed by writing the result into the destination
+  // directly.
+  std::size_t coalesced_count = 0;
+
+  // Removed instructions that store into slots nothing reads, and removed
+  // instructions no path reaches.
+  std::size_t dead_store_count = 0;
+  std::size_t unreachable_count = 0;
+
+  // Jump targets moved past NOPs and GOTOs, and removed NOPs and GOTOs to
+  // the next instruction.
+  std::size_t threaded_jump_count = 0;
+  std::size_t removed_nop_count = 0;
+  std::size_t removed_jump_count = 0;
+
+  // Frame slots saved by letting locals and temporaries share slots.
+  std::size_t packed_slot_count = 0;
+
+  // Untyped locals and temporaries that took the one type of every value
+  // stored into them, and generic arithmetic and comparisons rewritten into
+  // their typed forms.
+  std::size_t inferred_slot_count = 0;
+  std::size_t specialized_count = 0;
+
+  // Calls replaced by a copy of the code of the function they call.
+  std::size_t inlined_call_count = 0;
+};
+
+// Sets the optimization level. 0 turns the optimizer off, 1 runs type
+// inference, inlining, constant folding, copy propagation, dead code
+// elimination, the peephole pass on jumps and the packing of frame slots. The
+// default is 1.
+void SetOptimizationLevel(int level);
+
+// Gets the optimization level.
+int GetOptimizationLevel();
+
+// Sets the size, in words of optimized code, of the largest function whose
+// calls are inlined. 0 turns inlining off. The default is 32.
+void SetInlineLimit(std::size_t limit);
+
+// Gets the size of the largest function whose calls are inlined.
+std::size_t GetInlineLimit();
+
+// Adds an int or float literal of the code to the global memory and returns
+// its slot. The optimizer only folds literals added this way.
+std::size_t AddIntLiteral(Interpreter& interpreter, int64_t value);
+std::size_t AddFloatLiteral(Interpreter& interpreter, double value);
+
+// Optimizes the finished |code| of the function being generated, whose
+// parameters are |parameters_index|. Only the locals and temporaries in the
+// activation frame that no instruction can reach by reference are
+// optimized, so in functions without a frame only jumps and unreachable code
+// change. Slots of the frame may be renumbered, which updates the frame of
+// the function context and |parameters_index|. Run before the function is
+// registered. Returns the vm type of the value the function returns on every
+// path, or 0x00 if it may return values of different types or none.
+uint8_t OptimizeFunction(Interpreter& interpreter,
+                         std::vector<std::size_t>& parameters_index,
+                         std::vector<Bytecode>& code);
+
+// Records the optimized |code| of the function |name|, whose parameters are
+// |parameters_index|, so that the functions generated after it inline its
+// calls. Functions larger than the inline limit, variadic functions, functions
+// that call themselves and functions whose code uses references or reads a
+// local before writing it are left out. Run after OptimizeFunction().
+void AddInlineCandidate(Interpreter& interpreter, const std::string& name,
+                        std::vector<std::size_t>& parameters_index,
+                        std::vector<Bytecode>& code, bool is_variadic);
+
+// Gets the counters of the optimizer.
+const OptimizerStats& GetOptimizerStats();
+}  // namespace Interpreter
+}  // namespace Aq
+
+#endif
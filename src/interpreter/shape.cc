@@ -0,0 +1,42 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#include "interpreter/shape.h"
+
+namespace Aq {
+namespace Interpreter {
+// Shapes with more members than this index their slots by name.
+constexpr std::size_t kLinearShapeSize = 8;
+
+Shape* Shape::GetEmptyShape() {
+  static Shape* empty_shape = new Shape();
+  return empty_shape;
+}
+
+std::size_t Shape::FindSlot(Symbol name) const {
+  if (names_.size() > kLinearShapeSize) {
+    auto iterator = slots_.find(name);
+    return iterator == slots_.end() ? kNoSlot : iterator->second;
+  }
+
+  for (std::size_t i = 0; i < names_.size(); i++)
+    if (names_[i] == name) return i;
+  return kNoSlot;
+}
+
+Shape* Shape::AddMember(Symbol name) {
+  auto iterator = transitions_.find(name);
+  if (iterator != transitions_.end()) return iterator->second;
+
+  Shape* shape = new Shape();
+  shape->names_ = names_;
+  shape->names_.push_back(name);
+  if (shape->names_.size() > kLinearShapeSize)
+    for (std::size_t i = 0; i < shape->names_.size(); i++)
+      shape->slots_[shape->names_[i]] = i;
+  transitions_[name] = shape;
+  return shape;
+}
+}  // namespace Interpreter
+}  // namespace Aq
@@ -0,0 +1,62 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#ifndef AQ_INTERPRETER_SHAPE_H_
+#define AQ_INTERPRETER_SHAPE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "interpreter/symbol.h"
+
+namespace Aq {
+namespace Interpreter {
+// Shape describes the layout of class objects: which member lives in which
+// slot. Objects with the same members added in the same order share a shape,
+// so a class object only stores a flat vector of slots and a pointer to its
+// shape. Adding a member moves an object to a child shape with the member
+// appended, so the slots of existing members never change. Shapes are shared
+// by all interpreters of the process and are never freed.
+class Shape {
+ public:
+  // Returned by FindSlot() if the shape has no such member.
+  static constexpr std::size_t kNoSlot = SIZE_MAX;
+
+  // Gets the shape without members that all class objects start from.
+  static Shape* GetEmptyShape();
+
+  // Gets the slot of the member |name|, or kNoSlot if there is none.
+  std::size_t FindSlot(Symbol name) const;
+
+  // Gets the shape with the member |name| appended to the members of this
+  // shape. The shape is created on first use and shared afterwards.
+  Shape* AddMember(Symbol name);
+
+  // Gets the name of the member in |slot|.
+  Symbol GetName(std::size_t slot) const { return names_[slot]; }
+
+  // Gets the number of members.
+  std::size_t GetSize() const { return names_.size(); }
+
+ private:
+  Shape() = default;
+  Shape(const Shape&) = delete;
+  Shape& operator=(const Shape&) = delete;
+
+  // Member names in slot order. Small shapes are searched linearly, which is
+  // faster than hashing for the few members most classes have.
+  std::vector<Symbol> names_;
+
+  // Slots by name, only filled for large shapes.
+  std::unordered_map<Symbol, std::size_t> slots_;
+
+  // Child shapes by the name of the member they append.
+  std::unordered_map<Symbol, Shape*> transitions_;
+};
+}  // namespace Interpreter
+}  // namespace Aq
+
+#endif
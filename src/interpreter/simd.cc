@@ -0,0 +1,593 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#include "interpreter/simd.h"
+
+// SSE2 is part of every x86-64 CPU. AVX2 kernels are compiled for a target
+// attribute and only run if the CPU supports them, which needs GCC or Clang.
+#if defined(__x86_64__) || defined(_M_X64)
+#define AQ_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(AQ_SIMD_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define AQ_SIMD_AVX2
+#include <immintrin.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+namespace Aq {
+namespace Interpreter {
+SimdLevel DetectSimdLevel() {
+#ifdef AQ_SIMD_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return SimdLevel::kAvx2;
+#endif
+#ifdef AQ_SIMD_SSE2
+  return SimdLevel::kSse2;
+#else
+  return SimdLevel::kScalar;
+#endif
+}
+
+SimdLevel GetSimdLevel() {
+  static const SimdLevel level = DetectSimdLevel();
+  return level;
+}
+
+const char* GetSimdLevelName(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::kAvx2:
+      return "AVX2";
+    case SimdLevel::kSse2:
+      return "SSE2";
+    default:
+      return "scalar code";
+  }
+}
+
+// The scalar kernels run on CPUs without vector instructions and on the
+// elements left after the last full vector. Ints are added and multiplied as
+// unsigned so they wrap around instead of overflowing.
+
+int64_t SumLongsScalar(const int64_t* data, std::size_t size) {
+  uint64_t sum = 0;
+  for (std::size_t i = 0; i < size; i++) sum += data[i];
+  return static_cast<int64_t>(sum);
+}
+
+double SumDoublesScalar(const double* data, std::size_t size) {
+  double sum = 0;
+  for (std::size_t i = 0; i < size; i++) sum += data[i];
+  return sum;
+}
+
+int64_t DotLongsScalar(const int64_t* a, const int64_t* b, std::size_t size) {
+  uint64_t sum = 0;
+  for (std::size_t i = 0; i < size; i++)
+    sum += static_cast<uint64_t>(a[i]) * static_cast<uint64_t>(b[i]);
+  return static_cast<int64_t>(sum);
+}
+
+double DotDoublesScalar(const double* a, const double* b, std::size_t size) {
+  double sum = 0;
+  for (std::size_t i = 0; i < size; i++) sum += a[i] * b[i];
+  return sum;
+}
+
+int64_t MinLongsScalar(const int64_t* data, std::size_t size) {
+  int64_t result = data[0];
+  for (std::size_t i = 1; i < size; i++)
+    if (data[i] < result) result = data[i];
+  return result;
+}
+
+double MinDoublesScalar(const double* data, std::size_t size) {
+  double result = data[0];
+  for (std::size_t i = 1; i < size; i++)
+    if (data[i] < result) result = data[i];
+  return result;
+}
+
+int64_t MaxLongsScalar(const int64_t* data, std::size_t size) {
+  int64_t result = data[0];
+  for (std::size_t i = 1; i < size; i++)
+    if (data[i] > result) result = data[i];
+  return result;
+}
+
+double MaxDoublesScalar(const double* data, std::size_t size) {
+  double result = data[0];
+  for (std::size_t i = 1; i < size; i++)
+    if (data[i] > result) result = data[i];
+  return result;
+}
+
+void AddLongsScalar(const int64_t* a, const int64_t* b, int64_t* result,
+                    std::size_t size) {
+  for (std::size_t i = 0; i < size; i++)
+    result[i] = static_cast<int64_t>(static_cast<uint64_t>(a[i]) +
+                                     static_cast<uint64_t>(b[i]));
+}
+
+void AddDoublesScalar(const double* a, const double* b, double* result,
+                      std::size_t size) {
+  for (std::size_t i = 0; i < size; i++) result[i] = a[i] + b[i];
+}
+
+void MulLongsScalar(const int64_t* a, const int64_t* b, int64_t* result,
+                    std::size_t size) {
+  for (std::size_t i = 0; i < size; i++)
+    result[i] = static_cast<int64_t>(static_cast<uint64_t>(a[i]) *
+                                     static_cast<uint64_t>(b[i]));
+}
+
+void MulDoublesScalar(const double* a, const double* b, double* result,
+                      std::size_t size) {
+  for (std::size_t i = 0; i < size; i++) result[i] = a[i] * b[i];
+}
+
+void FillLongsScalar(int64_t* data, std::size_t size, int64_t value) {
+  for (std::size_t i = 0; i < size; i++) data[i] = value;
+}
+
+void FillDoublesScalar(double* data, std::size_t size, double value) {
+  for (std::size_t i = 0; i < size; i++) data[i] = value;
+}
+
+#ifdef AQ_SIMD_SSE2
+// The SSE2 kernels handle 2 elements at a time. SSE2 has no 64-bit int
+// multiplication or comparison, so the int dot product, products, minimum and
+// maximum stay scalar.
+
+int64_t SumLongsSse2(const int64_t* data, std::size_t size) {
+  __m128i sum = _mm_setzero_si128();
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    sum = _mm_add_epi64(
+        sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+  int64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+  return static_cast<int64_t>(static_cast<uint64_t>(lanes[0]) +
+                              static_cast<uint64_t>(lanes[1]) +
+                              static_cast<uint64_t>(
+                                  SumLongsScalar(data + i, size - i)));
+}
+
+double SumDoublesSse2(const double* data, std::size_t size) {
+  __m128d sum0 = _mm_setzero_pd();
+  __m128d sum1 = _mm_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    sum0 = _mm_add_pd(sum0, _mm_loadu_pd(data + i));
+    sum1 = _mm_add_pd(sum1, _mm_loadu_pd(data + i + 2));
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+  return lanes[0] + lanes[1] + SumDoublesScalar(data + i, size - i);
+}
+
+double DotDoublesSse2(const double* a, const double* b, std::size_t size) {
+  __m128d sum0 = _mm_setzero_pd();
+  __m128d sum1 = _mm_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    sum1 = _mm_add_pd(
+        sum1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(sum0, sum1));
+  return lanes[0] + lanes[1] + DotDoublesScalar(a + i, b + i, size - i);
+}
+
+double MinDoublesSse2(const double* data, std::size_t size) {
+  if (size < 2) return MinDoublesScalar(data, size);
+  __m128d result = _mm_loadu_pd(data);
+  std::size_t i = 2;
+  for (; i + 2 <= size; i += 2)
+    result = _mm_min_pd(_mm_loadu_pd(data + i), result);
+  double lanes[2];
+  _mm_storeu_pd(lanes, result);
+  double tail = lanes[0] < lanes[1] ? lanes[0] : lanes[1];
+  for (; i < size; i++)
+    if (data[i] < tail) tail = data[i];
+  return tail;
+}
+
+double MaxDoublesSse2(const double* data, std::size_t size) {
+  if (size < 2) return MaxDoublesScalar(data, size);
+  __m128d result = _mm_loadu_pd(data);
+  std::size_t i = 2;
+  for (; i + 2 <= size; i += 2)
+    result = _mm_max_pd(_mm_loadu_pd(data + i), result);
+  double lanes[2];
+  _mm_storeu_pd(lanes, result);
+  double tail = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+  for (; i < size; i++)
+    if (data[i] > tail) tail = data[i];
+  return tail;
+}
+
+void AddLongsSse2(const int64_t* a, const int64_t* b, int64_t* result,
+                  std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(result + i),
+        _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i))));
+  AddLongsScalar(a + i, b + i, result + i, size - i);
+}
+
+void AddDoublesSse2(const double* a, const double* b, double* result,
+                    std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    _mm_storeu_pd(result + i,
+                  _mm_add_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  AddDoublesScalar(a + i, b + i, result + i, size - i);
+}
+
+void MulDoublesSse2(const double* a, const double* b, double* result,
+                    std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    _mm_storeu_pd(result + i,
+                  _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  MulDoublesScalar(a + i, b + i, result + i, size - i);
+}
+
+void FillLongsSse2(int64_t* data, std::size_t size, int64_t value) {
+  __m128i vector = _mm_set1_epi64x(value);
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), vector);
+  FillLongsScalar(data + i, size - i, value);
+}
+
+void FillDoublesSse2(double* data, std::size_t size, double value) {
+  __m128d vector = _mm_set1_pd(value);
+  std::size_t i = 0;
+  for (; i + 2 <= size; i += 2) _mm_storeu_pd(data + i, vector);
+  FillDoublesScalar(data + i, size - i, value);
+}
+#endif
+
+#ifdef AQ_SIMD_AVX2
+// The AVX2 kernels handle 4 elements at a time. AVX2 compares 64-bit ints but
+// can't multiply them, so the int dot product and products stay scalar.
+
+AVX2_TARGET int64_t SumLongsAvx2(const int64_t* data, std::size_t size) {
+  __m256i sum = _mm256_setzero_si256();
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    sum = _mm256_add_epi64(
+        sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+  uint64_t result = static_cast<uint64_t>(SumLongsScalar(data + i, size - i));
+  for (int64_t lane : lanes) result += static_cast<uint64_t>(lane);
+  return static_cast<int64_t>(result);
+}
+
+AVX2_TARGET double SumDoublesAvx2(const double* data, std::size_t size) {
+  __m256d sum0 = _mm256_setzero_pd();
+  __m256d sum1 = _mm256_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    sum0 = _mm256_add_pd(sum0, _mm256_loadu_pd(data + i));
+    sum1 = _mm256_add_pd(sum1, _mm256_loadu_pd(data + i + 4));
+  }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(sum0, sum1));
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) +
+         SumDoublesScalar(data + i, size - i);
+}
+
+AVX2_TARGET double DotDoublesAvx2(const double* a, const double* b,
+                                  std::size_t size) {
+  __m256d sum0 = _mm256_setzero_pd();
+  __m256d sum1 = _mm256_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    sum0 = _mm256_add_pd(
+        sum0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4),
+                                             _mm256_loadu_pd(b + i + 4)));
+  }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(sum0, sum1));
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) +
+         DotDoublesScalar(a + i, b + i, size - i);
+}
+
+AVX2_TARGET int64_t MinLongsAvx2(const int64_t* data, std::size_t size) {
+  if (size < 4) return MinLongsScalar(data, size);
+  __m256i result = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+  std::size_t i = 4;
+  for (; i + 4 <= size; i += 4) {
+    __m256i vector =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    result = _mm256_blendv_epi8(result, vector,
+                                _mm256_cmpgt_epi64(result, vector));
+  }
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), result);
+  int64_t tail = MinLongsScalar(lanes, 4);
+  for (; i < size; i++)
+    if (data[i] < tail) tail = data[i];
+  return tail;
+}
+
+AVX2_TARGET int64_t MaxLongsAvx2(const int64_t* data, std::size_t size) {
+  if (size < 4) return MaxLongsScalar(data, size);
+  __m256i result = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+  std::size_t i = 4;
+  for (; i + 4 <= size; i += 4) {
+    __m256i vector =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    result = _mm256_blendv_epi8(result, vector,
+                                _mm256_cmpgt_epi64(vector, result));
+  }
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), result);
+  int64_t tail = MaxLongsScalar(lanes, 4);
+  for (; i < size; i++)
+    if (data[i] > tail) tail = data[i];
+  return tail;
+}
+
+AVX2_TARGET double MinDoublesAvx2(const double* data, std::size_t size) {
+  if (size < 4) return MinDoublesScalar(data, size);
+  __m256d result = _mm256_loadu_pd(data);
+  std::size_t i = 4;
+  for (; i + 4 <= size; i += 4)
+    result = _mm256_min_pd(_mm256_loadu_pd(data + i), result);
+  double lanes[4];
+  _mm256_storeu_pd(lanes, result);
+  double tail = MinDoublesScalar(lanes, 4);
+  for (; i < size; i++)
+    if (data[i] < tail) tail = data[i];
+  return tail;
+}
+
+AVX2_TARGET double MaxDoublesAvx2(const double* data, std::size_t size) {
+  if (size < 4) return MaxDoublesScalar(data, size);
+  __m256d result = _mm256_loadu_pd(data);
+  std::size_t i = 4;
+  for (; i + 4 <= size; i += 4)
+    result = _mm256_max_pd(_mm256_loadu_pd(data + i), result);
+  double lanes[4];
+  _mm256_storeu_pd(lanes, result);
+  double tail = MaxDoublesScalar(lanes, 4);
+  for (; i < size; i++)
+    if (data[i] > tail) tail = data[i];
+  return tail;
+}
+
+AVX2_TARGET void AddLongsAvx2(const int64_t* a, const int64_t* b,
+                              int64_t* result, std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(result + i),
+        _mm256_add_epi64(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i))));
+  AddLongsScalar(a + i, b + i, result + i, size - i);
+}
+
+AVX2_TARGET void AddDoublesAvx2(const double* a, const double* b,
+                                double* result, std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(result + i, _mm256_add_pd(_mm256_loadu_pd(a + i),
+                                               _mm256_loadu_pd(b + i)));
+  AddDoublesScalar(a + i, b + i, result + i, size - i);
+}
+
+AVX2_TARGET void MulDoublesAvx2(const double* a, const double* b,
+                                double* result, std::size_t size) {
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_pd(result + i, _mm256_mul_pd(_mm256_loadu_pd(a + i),
+                                               _mm256_loadu_pd(b + i)));
+  MulDoublesScalar(a + i, b + i, result + i, size - i);
+}
+
+AVX2_TARGET void FillLongsAvx2(int64_t* data, std::size_t size,
+                               int64_t value) {
+  __m256i vector = _mm256_set1_epi64x(value);
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4)
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), vector);
+  FillLongsScalar(data + i, size - i, value);
+}
+
+AVX2_TARGET void FillDoublesAvx2(double* data, std::size_t size,
+                                 double value) {
+  __m256d vector = _mm256_set1_pd(value);
+  std::size_t i = 0;
+  for (; i + 4 <= size; i += 4) _mm256_storeu_pd(data + i, vector);
+  FillDoublesScalar(data + i, size - i, value);
+}
+#endif
+
+int64_t SumLongs(const int64_t* data, std::size_t size) {
+  switch (GetSimdLevel()) {
+#ifdef AQ_SIMD_AVX2
+    case SimdLevel::kAvx2:
+      return SumLongsAvx2(data, size);
+#endif
+#ifdef AQ_SIMD_SSE2
+    case SimdLevel::kSse2:
+      return SumLongsSse2(data, size);
+#endif
+    default:
+      return SumLongsScalar(data, size);
+  }
+}
+
+double SumDoubles(const double* data, std::size_t size) {
+  switch (GetSimdLevel()) {
+#ifdef AQ_SIMD_AVX2
+    case SimdLevel::kAvx2:
+      return SumDoublesAvx2(data, size);
+#endif
+#ifdef AQ_SIMD_SSE2
+    case SimdLevel::kSse2:
+      return SumDoublesSse2(data, size);
+#endif
+    default:
+      return SumDoublesScalar(data, size);
+  }
+}
+
+int64_t DotLongs(const int64_t* a, const int64_t* b, std::size_t size) {
+  return DotLongsScalar(a, b, size);
+}
+
+double DotDoubles(const double* a, const double* b, std::size_t size) {
+  switch (GetSimdLevel()) {
+#ifdef AQ_SIMD_AVX2
+    case SimdLevel::kAvx2:
+      return DotDoublesAvx2(a, b, size);
+#endif
+#ifdef AQ_SIMD_SSE2
+    case SimdLevel::kSse2:
+      return DotDoublesSse2(a, b, size);
+#endif
+    default:
+      return DotDoublesScalar(a, b, size);
+  }
+}
+
+int64_t MinLongs(const int64_t* data, std::size_t size) {
+#ifdef AQ_SIMD_AVX2
+  if (GetSimdLevel() == SimdLevel::kAvx2) return MinLongsAvx2(data, size);
+#endif
+  return MinLongsScalar(data, size);
+}
+
+double MinDoubles(const double* data, std::size_t size) {
+  switch (GetSimdLevel()) {
+#ifdef AQ_SIMD_AVX2
+    case SimdLevel::kAvx2:
+      return MinDoublesAvx2(data, size);
+#endif
+#ifdef AQ_SIMD_SSE2
+    case SimdLevel::kSse2:
+      return MinDoublesSse2(data, size);
+#endif
+    default:
+      return MinDoublesScalar(data, size);
+  }
+}
+
+int64_t MaxLongs(const int64_t* data, std::size_t size) {
+#ifdef AQ_SIMD_AVX2
+  if (GetSimdLevel() == SimdLevel::kAvx2) return MaxLongsAvx2(data, size);
+#endif
+  return MaxLongsScalar(data, size);
+}
+
+double MaxDoubles(const double* data, std::size_t size) {
+  switch (GetSimdLevel()) {
+#ifdef AQ_SIMD_AVX2
+    case SimdLevel::kAvx2:
+      return MaxDoublesAvx2(data, size);
+#endif
+#ifdef AQ_SIMD_SSE2
+    case SimdLevel::kSse2:
+      return MaxDoublesSse2(data, size);
+#endif
+    default:
+      return MaxDoublesScalar(data, size);
+  }
+}
+
+void AddLongs(const int64_t* a, const int64_t* b, int64_t* result,
+              std::size_t size) {
+  switch (GetSimdLevel()) {
+#ifdef AQ_SIMD_AVX2
+    case SimdLevel::kAvx2:
+      return AddLongsAvx2(a, b, result, size);
+#endif
+#ifdef AQ_SIMD_SSE2
+    case SimdLevel::kSse2:
+      return AddLongsSse2(a, b, result, size);
+#endif
+    default:
+      return AddLongsScalar(a, b, result, size);
+  }
+}
+
+void AddDoubles(const double* a, const double* b, double* result,
+                std::size_t size) {
+  switch (GetSimdLevel()) {
+#ifdef AQ_SIMD_AVX2
+    case SimdLevel::kAvx2:
+      return AddDoublesAvx2(a, b, result, size);
+#endif
+#ifdef AQ_SIMD_SSE2
+    case SimdLevel::kSse2:
+      return AddDoublesSse2(a, b, result, size);
+#endif
+    default:
+      return AddDoublesScalar(a, b, result, size);
+  }
+}
+
+void MulLongs(const int64_t* a, const int64_t* b, int64_t* result,
+              std::size_t size) {
+  MulLongsScalar(a, b, result, size);
+}
+
+void MulDoubles(const double* a, const double* b, double* result,
+                std::size_t size) {
+  switch (GetSimdLevel()) {
+#ifdef AQ_SIMD_AVX2
+    case SimdLevel::kAvx2:
+      return MulDoublesAvx2(a, b, result, size);
+#endif
+#ifdef AQ_SIMD_SSE2
+    case SimdLevel::kSse2:
+      return MulDoublesSse2(a, b, result, size);
+#endif
+    default:
+      return MulDoublesScalar(a, b, result, size);
+  }
+}
+
+void FillLongs(int64_t* data, std::size_t size, int64_t value) {
+  switch (GetSimdLevel()) {
+#ifdef AQ_SIMD_AVX2
+    case SimdLevel::kAvx2:
+      return FillLongsAvx2(data, size, value);
+#endif
+#ifdef AQ_SIMD_SSE2
+    case SimdLevel::kSse2:
+      return FillLongsSse2(data, size, value);
+#endif
+    default:
+      return FillLongsScalar(data, size, value);
+  }
+}
+
+void FillDoubles(double* data, std::size_t size, double value) {
+  switch (GetSimdLevel()) {
+#ifdef AQ_SIMD_AVX2
+    case SimdLevel::kAvx2:
+      return FillDoublesAvx2(data, size, value);
+#endif
+#ifdef AQ_SIMD_SSE2
+    case SimdLevel::kSse2:
+      return FillDoublesSse2(data, size, value);
+#endif
+    default:
+      return FillDoublesScalar(data, size, value);
+  }
+}
+}  // namespace Interpreter
+}  // namespace Aq
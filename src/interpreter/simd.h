@@ -0,0 +1,59 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#ifndef AQ_INTERPRETER_SIMD_H_
+#define AQ_INTERPRETER_SIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Aq {
+namespace Interpreter {
+// The instruction sets the array kernels can run on.
+enum class SimdLevel { kScalar, kSse2, kAvx2 };
+
+// Gets the widest instruction set the CPU supports. It is detected once, the
+// first time a kernel runs.
+SimdLevel GetSimdLevel();
+
+// Gets the name of |level| for the logs.
+const char* GetSimdLevelName(SimdLevel level);
+
+// Kernels over arrays of ints and floats. Each runs on the instruction set
+// GetSimdLevel() picks. The float kernels add up the elements in a different
+// order than a loop, so their sums may differ from one in the last bits.
+
+// Gets the sum of the |size| elements of |data|.
+int64_t SumLongs(const int64_t* data, std::size_t size);
+double SumDoubles(const double* data, std::size_t size);
+
+// Gets the dot product of the |size| elements of |a| and |b|.
+int64_t DotLongs(const int64_t* a, const int64_t* b, std::size_t size);
+double DotDoubles(const double* a, const double* b, std::size_t size);
+
+// Gets the smallest and the largest of the |size| elements of |data|. |size|
+// must not be 0.
+int64_t MinLongs(const int64_t* data, std::size_t size);
+double MinDoubles(const double* data, std::size_t size);
+int64_t MaxLongs(const int64_t* data, std::size_t size);
+double MaxDoubles(const double* data, std::size_t size);
+
+// Stores the element-wise sums and products of the |size| elements of |a|
+// and |b| into |result|.
+void AddLongs(const int64_t* a, const int64_t* b, int64_t* result,
+              std::size_t size);
+void AddDoubles(const double* a, const double* b, double* result,
+                std::size_t size);
+void MulLongs(const int64_t* a, const int64_t* b, int64_t* result,
+              std::size_t size);
+void MulDoubles(const double* a, const double* b, double* result,
+                std::size_t size);
+
+// Sets the |size| elements of |data| to |value|.
+void FillLongs(int64_t* data, std::size_t size, int64_t value);
+void FillDoubles(double* data, std::size_t size, double value);
+}  // namespace Interpreter
+}  // namespace Aq
+
+#endif
@@ -113,10 +113,10 @@ void HandleStatement(Interpreter& interpreter, Ast::Statement* statement,
 
 void HandleBreakStatement(Interpreter& interpreter,
                           std::vector<Bytecode>& code) {
-  std::size_t index = interpreter.global_memory->AddUint64t(0);
-  code.push_back(Bytecode{_AQVM_OPERATOR_GOTO, {index}});
-
-  interpreter.context.function_context->loop_break_index.push_back(index);
+  // The target is set once the enclosing loop is finished.
+  interpreter.context.function_context->loop_break_index.push_back(
+      code.size());
+  code.push_back(Bytecode{_AQVM_OPERATOR_GOTO, {}});
 }
 
 void HandleClassStatement(Interpreter& interpreter, Ast::Statement* statement,
@@ -267,7 +267,6 @@ void HandleIfStatement(Interpreter& interpreter, Ast::If* statement,
   // Gets the reference of context.
   auto& scopes = interpreter.context.scopes;
   auto& undefined_count = interpreter.context.undefined_count;
-  auto& global_memory = interpreter.global_memory;
 
   std::size_t condition_index =
       HandleExpression(interpreter, statement->GetConditionExpression(), code);
@@ -302,12 +301,11 @@ void HandleIfStatement(Interpreter& interpreter, Ast::If* statement,
   // Sets the arguments for the if and goto operators.
   std::vector<std::size_t> if_arguments{condition_index, true_operator_location,
                                         false_operator_location};
-  std::vector<std::size_t> goto_arguments{
-      global_memory->AddUint64t(exit_branch)};
+  std::vector<std::size_t> goto_arguments{exit_branch};
 
   // Updates the if and goto operators with the arguments.
-  code[if_operator_index].arguments = std::move(if_arguments);
-  code[goto_operator_location].arguments = std::move(goto_arguments);
+  code[if_operator_index].SetOperands(if_arguments);
+  code[goto_operator_location].SetOperands(goto_arguments);
 }
 
 void HandleWhileStatement(Interpreter& interpreter, Ast::While* statement,
@@ -317,7 +315,6 @@ void HandleWhileStatement(Interpreter& interpreter, Ast::While* statement,
   // Gets the reference of context.
   auto& scopes = interpreter.context.scopes;
   auto& undefined_count = interpreter.context.undefined_count;
-  auto& global_memory = interpreter.global_memory;
   auto& loop_break_index =
       interpreter.context.function_context->loop_break_index;
 
@@ -343,8 +340,7 @@ void HandleWhileStatement(Interpreter& interpreter, Ast::While* statement,
   scopes.pop_back();
 
   // Handles the goto operator to jump back to the start of the loop.
-  code.push_back(Bytecode{_AQVM_OPERATOR_GOTO,
-                          {global_memory->AddUint64t(start_location)}});
+  code.push_back(Bytecode{_AQVM_OPERATOR_GOTO, {start_location}});
 
   // Handles the exit branch of the while statement.
   std::size_t exit_location = code.size();
@@ -353,11 +349,11 @@ void HandleWhileStatement(Interpreter& interpreter, Ast::While* statement,
   // Sets the arguments for the if and goto operators.
   std::vector<std::size_t> if_arguments{condition_index, body_location,
                                         exit_location};
-  code[if_location].arguments = std::move(if_arguments);
+  code[if_location].SetOperands(if_arguments);
 
   // Sets the exit location for the loop break statements.
   while (loop_break_index.back() != -1) {
-    global_memory->SetUint64tValue(loop_break_index.back(), exit_location);
+    code[loop_break_index.back()].SetOperands({exit_location});
     loop_break_index.pop_back();
   }
 
@@ -371,7 +367,6 @@ void HandleDowhileStatement(Interpreter& interpreter, Ast::DoWhile* statement,
   // Gets the reference of context.
   auto& scopes = interpreter.context.scopes;
   auto& undefined_count = interpreter.context.undefined_count;
-  auto& global_memory = interpreter.global_memory;
   auto& loop_break_index =
       interpreter.context.function_context->loop_break_index;
 
@@ -401,11 +396,11 @@ void HandleDowhileStatement(Interpreter& interpreter, Ast::DoWhile* statement,
   // Sets the arguments for the if and goto operators.
   std::vector<std::size_t> if_args{condition_index, body_location,
                                    exit_location};
-  code[if_location].arguments = std::move(if_args);
+  code[if_location].SetOperands(if_args);
 
   // Sets the exit location for the loop break statements.
   while (loop_break_index.back() != -1) {
-    global_memory->SetUint64tValue(loop_break_index.back(), exit_location);
+    code[loop_break_index.back()].SetOperands({exit_location});
     loop_break_index.pop_back();
   }
 
@@ -419,7 +414,6 @@ void HandleForStatement(Interpreter& interpreter, Ast::For* statement,
   // Gets the reference of context.
   auto& scopes = interpreter.context.scopes;
   auto& undefined_count = interpreter.context.undefined_count;
-  auto& global_memory = interpreter.global_memory;
   auto& loop_break_index =
       interpreter.context.function_context->loop_break_index;
 
@@ -454,8 +448,7 @@ void HandleForStatement(Interpreter& interpreter, Ast::For* statement,
 
   // LOGGING_INFO("1");
   //  Makes the for statement loop automatically.
-  code.push_back(Bytecode{_AQVM_OPERATOR_GOTO,
-                          {global_memory->AddUint64t(start_location)}});
+  code.push_back(Bytecode{_AQVM_OPERATOR_GOTO, {start_location}});
 
   // Handles the exit branch of the for statement.
   std::size_t exit_location = code.size();
@@ -464,11 +457,11 @@ void HandleForStatement(Interpreter& interpreter, Ast::For* statement,
   // Sets the arguments for the if and goto operators.
   std::vector<std::size_t> if_args{condition_index, body_location,
                                    exit_location};
-  code[if_location].arguments = std::move(if_args);
+  code[if_location].SetOperands(if_args);
 
   // Sets the exit location for the loop break statements.
   while (loop_break_index.back() != -1) {
-    global_memory->SetUint64tValue(loop_break_index.back(), exit_location);
+    code[loop_break_index.back()].SetOperands({exit_location});
     loop_break_index.pop_back();
   }
 
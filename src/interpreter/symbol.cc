@@ -0,0 +1,51 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#include "interpreter/symbol.h"
+
+#include <deque>
+#include <unordered_map>
+
+#include "logging/logging.h"
+
+namespace Aq {
+namespace Interpreter {
+struct SymbolTable {
+  SymbolTable() { Intern("@name"); }
+
+  Symbol Intern(const std::string& name) {
+    auto iterator = symbols.find(name);
+    if (iterator != symbols.end()) return iterator->second;
+
+    Symbol symbol = names.size();
+    names.push_back(name);
+    symbols[name] = symbol;
+    return symbol;
+  }
+
+  // The names never move, so references returned by GetSymbolName() stay
+  // valid while new names are interned.
+  std::deque<std::string> names;
+  std::unordered_map<std::string, Symbol> symbols;
+};
+
+// Gets the table of the process. It is created on first use so that names can
+// be interned during static initialization.
+SymbolTable& GetSymbolTable() {
+  static SymbolTable table;
+  return table;
+}
+
+Symbol InternSymbol(const std::string& name) {
+  return GetSymbolTable().Intern(name);
+}
+
+const std::string& GetSymbolName(Symbol symbol) {
+  auto& names = GetSymbolTable().names;
+  if (symbol >= names.size())
+    INTERNAL_ERROR("Unknown symbol: " + std::to_string(symbol));
+  return names[symbol];
+}
+}  // namespace Interpreter
+}  // namespace Aq
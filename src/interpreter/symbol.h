@@ -0,0 +1,29 @@
+// Copyright 2025 AQ author, All Rights Reserved.
+// This program is licensed under the AQ License. You can find the AQ license in
+// the root directory.
+
+#ifndef AQ_INTERPRETER_SYMBOL_H_
+#define AQ_INTERPRETER_SYMBOL_H_
+
+#include <cstdint>
+#include <string>
+
+namespace Aq {
+namespace Interpreter {
+// A small integer that stands for an interned name. Names are interned in a
+// table shared by all interpreters of the process, so equal names get equal
+// symbols across modules.
+typedef uint32_t Symbol;
+
+// The symbol of the @name member that every class object carries.
+constexpr Symbol kClassNameSymbol = 0;
+
+// Gets the symbol of |name|, interning it if it is new.
+Symbol InternSymbol(const std::string& name);
+
+// Gets the name that |symbol| was interned for.
+const std::string& GetSymbolName(Symbol symbol);
+}  // namespace Interpreter
+}  // namespace Aq
+
+#endif